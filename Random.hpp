@@ -6,16 +6,207 @@
 #include <random>
 #include "pcg/pcg_random.hpp"
 #include <array>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define RANDOM_HAS_PMR
+#endif
+#endif
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RANDOM_HAS_POSIX
+#ifndef RANDOM_FILE_MEMORY_BUDGET
+#define RANDOM_FILE_MEMORY_BUDGET (std::size_t(256) << 20)
+#endif
+#ifndef RANDOM_WRITE_BUFFER_SIZE
+#define RANDOM_WRITE_BUFFER_SIZE (std::size_t(1) << 20)
+#endif
+#endif
+#if defined(RANDOM_ENABLE_PROFILER) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/random.h>)
+#include <sys/random.h>
+#define RANDOM_HAS_GETRANDOM
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RANDOM_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define RANDOM_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define RANDOM_UNLIKELY(x) (x)
+#define RANDOM_NOINLINE __declspec(noinline)
+#else
+#define RANDOM_UNLIKELY(x) (x)
+#define RANDOM_NOINLINE
+#endif
+
+//Under RANDOM_ENABLE_PROFILER the public functions take the caller's location as a trailing
+//defaulted argument. Without it the signatures are the plain ones, so the API and ABI do not change.
+#ifdef RANDOM_ENABLE_PROFILER
+#define RANDOM_CALL_SITE , CallSite site = CallSite::Current()
+#define RANDOM_CALL_SITE_ONLY CallSite site = CallSite::Current()
+#define RANDOM_PROFILE_CALL const CallProfiler profile(site)
+#else
+#define RANDOM_CALL_SITE
+#define RANDOM_CALL_SITE_ONLY
+#define RANDOM_PROFILE_CALL static_cast<void>(0)
+#endif
 
 class Random
 {
-private:
-	pcg32 rng;
+	//Bulk engine behind FillBytes and WriteBytes. It runs several pcg32 states on different streams
+	//side by side and generates a block of outputs at a time. The lanes don't depend on each other,
+	//so the block loop isn't limited by the latency of a single LCG step, and it vectorizes.
+	//Lane l produces exactly the sequence of pcg32(state, stream * Lanes + l). Single draws would
+	//cost a buffer read plus a share of the refill, which is slower than stepping pcg32 inline, so
+	//the scalar API never uses it.
+	template<size_t Lanes = 16, size_t BlockSize = 256>
+	class BufferedEngine
+	{
+		static_assert(BlockSize % Lanes == 0, "BlockSize must be a multiple of Lanes.");
+	public:
+		using result_type = std::uint32_t;
+		using state_type = std::uint64_t;
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+		explicit BufferedEngine(std::uint64_t state, std::uint64_t stream = 0)
+		{
+			seed(state, stream);
+		}
+
+		/// <summary>
+		/// Seeds lane l like pcg32(state, stream * Lanes + l) and drops any buffered outputs.
+		/// </summary>
+		inline void seed(std::uint64_t state, std::uint64_t stream = 0)
+		{
+			for (size_t l = 0; l < Lanes; l++) {
+				SeedLane(l, state, stream * Lanes + l);
+			}
+			index = BlockSize;
+		}
+
+		inline result_type operator()()
+		{
+			size_t i = index;
+			if (RANDOM_UNLIKELY(i == BlockSize)) {
+				Refill();
+				i = 0;
+			}
+			index = i + 1;
+			return buffer[i];
+		}
+
+		/// <summary>
+		/// Writes the next n outputs to out, the same values n calls to operator() would return.
+		/// Whole blocks are generated straight into out without going through the buffer.
+		/// </summary>
+		inline void generate(result_type* out, size_t n)
+		{
+			for (; n != 0 && index != BlockSize; n--) {
+				*out++ = buffer[index++];
+			}
+			for (; n >= BlockSize; n -= BlockSize, out += BlockSize) {
+				Step(out);
+			}
+			for (; n != 0; n--) {
+				*out++ = (*this)();
+			}
+		}
+	private:
+		static constexpr std::uint64_t Multiplier = 6364136223846793005ull;
+
+		std::array<std::uint64_t, Lanes> state;
+		std::array<std::uint64_t, Lanes> inc;
+		std::array<result_type, BlockSize> buffer;
+		size_t index = BlockSize;
+
+		inline void SeedLane(size_t l, std::uint64_t initState, std::uint64_t stream)
+		{
+			inc[l] = (stream << 1) | 1u;
+			state[l] = (initState + inc[l]) * Multiplier + inc[l];
+		}
+
+		//pcg32's XSH RR output permutation.
+		inline static result_type Output(std::uint64_t s) noexcept
+		{
+			const std::uint32_t xorshifted = static_cast<std::uint32_t>(((s >> 18) ^ s) >> 27);
+			const std::uint32_t rot = static_cast<std::uint32_t>(s >> 59);
+			return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31u));
+		}
+
+		//Generates one block of outputs into out and advances every lane.
+		inline void Step(result_type* out)
+		{
+			std::uint64_t s[Lanes], c[Lanes];
+			for (size_t l = 0; l < Lanes; l++) {
+				s[l] = state[l];
+				c[l] = inc[l];
+			}
+			for (size_t j = 0; j < BlockSize; j += Lanes) {
+				for (size_t l = 0; l < Lanes; l++) {
+					out[j + l] = Output(s[l]);
+					s[l] = s[l] * Multiplier + c[l];
+				}
+			}
+			for (size_t l = 0; l < Lanes; l++) {
+				state[l] = s[l];
+			}
+		}
+
+		RANDOM_NOINLINE void Refill()
+		{
+			Step(buffer.data());
+			index = 0;
+		}
+	};
+
+	using Engine = pcg32;
+
+	Engine rng;
 public:
 	Random()
 	{
-		pcg_extras::seed_seq_from<std::random_device> seed_source;
-		rng.seed(seed_source);
+		SeedFromEntropy(rng);
+#if defined(__unix__) || defined(__APPLE__)
+		//a forked child would otherwise repeat the parent's sequence
+		pthread_atfork(nullptr, nullptr, [] {
+			CountForkReseed();
+			SeedFromEntropy(Get().rng);
+		});
+#endif
 	}
 
 	Random(const Random&) = delete;
@@ -61,6 +252,93 @@ public:
 		static constexpr const char* Binary
 			= "01";
 	};
+
+	/// <summary>
+	/// Groups of the global API, used to break down Stats().
+	/// </summary>
+	enum class Api : std::size_t
+	{
+		GetInt,
+		GetIntBinomial,
+		GetByte,
+		GetFloat,
+		GetFloatNormal,
+		Chance,
+		Shuffle,
+		GetString,
+		Arrays,
+		Shapes,
+		Samplers,
+		Ranges,
+		Files,
+		Count
+	};
+
+	static constexpr std::size_t ApiCount = static_cast<std::size_t>(Api::Count);
+
+	/// <summary>
+	/// Totals of the instrumentation counters across all threads. Only filled in when
+	/// RANDOM_ENABLE_STATS is defined.
+	/// </summary>
+	struct StatsSnapshot
+	{
+		bool enabled = false;
+		std::size_t threads = 0;
+		std::uint64_t engineSteps = 0;
+		std::uint64_t rejections = 0;
+		std::uint64_t reseeds = 0;
+		std::array<std::uint64_t, ApiCount> calls{};
+		std::array<std::uint64_t, ApiCount> steps{};
+
+		static constexpr const char* ApiName(Api api) noexcept
+		{
+			constexpr const char* names[ApiCount] = {
+				"GetInt", "GetIntBinomial", "GetByte", "GetFloat", "GetFloatNormal", "Chance",
+				"Shuffle", "GetString", "Arrays", "Shapes", "Samplers", "Ranges", "Files"
+			};
+			return names[static_cast<std::size_t>(api)];
+		}
+	};
+
+#ifdef RANDOM_ENABLE_PROFILER
+	/// <summary>
+	/// Source location of a call into the global API. It is filled in by a default argument, so it
+	/// names the caller, like std::source_location::current().
+	/// </summary>
+	struct CallSite
+	{
+		const char* file;
+		const char* function;
+		std::uint32_t line;
+
+#if defined(__GNUC__) || defined(__clang__)
+		static constexpr CallSite Current(const char* file = __builtin_FILE(), const char* function = __builtin_FUNCTION(),
+			std::uint32_t line = __builtin_LINE()) noexcept
+		{
+			return { file, function, line };
+		}
+#else
+		static constexpr CallSite Current() noexcept
+		{
+			return { "unknown", "unknown", 0 };
+		}
+#endif
+	};
+
+	/// <summary>
+	/// Profile of one call site. Calls, cycles and draws are totals over the sampled calls only.
+	/// </summary>
+	struct ProfileEntry
+	{
+		const char* file;
+		const char* function;
+		std::uint32_t line;
+		std::uint64_t samples;
+		std::uint64_t estimatedCalls;
+		std::uint64_t cycles;
+		std::uint64_t draws;
+	};
+#endif
 private:
 	inline static Random& Get() noexcept
 	{
@@ -68,266 +346,4329 @@ private:
 		return instance;
 	}
 
-	template <typename T> 
-	inline T GetInt_Impl(T begin, T end)
+#ifdef RANDOM_ENABLE_STATS
+	//Counters written only by their own thread, so updates are plain relaxed load/store pairs.
+	//Each block is a separate cache-line-aligned allocation, so threads never share a line.
+	struct alignas(64) StatsBlock
 	{
-		std::uniform_int_distribution<T> dis(begin, end);
-		return dis(rng);
+		std::atomic<std::uint64_t> calls[ApiCount]{};
+		std::atomic<std::uint64_t> steps[ApiCount]{};
+		std::atomic<std::uint64_t> rejections{};
+		std::atomic<std::uint64_t> reseeds{};
+	};
+
+	struct StatsRegistry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<StatsBlock>> blocks;
+	};
+
+	//Blocks outlive their threads, so counts from finished threads stay in the totals.
+	inline static StatsRegistry& Registry()
+	{
+		static StatsRegistry registry;
+		return registry;
 	}
 
-	template <typename T> 
-	inline T GetInt_Binomial_Impl(T t, double p)
+	inline static StatsBlock& LocalStats()
 	{
-		std::binomial_distribution<T> dis{ t, p };
-		return dis(rng);
+		thread_local StatsBlock* block = [] {
+			StatsRegistry& registry = Registry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.blocks.push_back(std::make_unique<StatsBlock>());
+			return registry.blocks.back().get();
+		}();
+		return *block;
 	}
 
-	template <typename T, size_t N> 
-	inline std::array<T, N>&& GetIntArray_Impl(T begin, T end)
+	inline static void Bump(std::atomic<std::uint64_t>& counter) noexcept
 	{
-		std::array<T, N>&& arr{};
-		std::uniform_int_distribution<T> distribution{ begin, end };
-		for (auto& i : arr) {
-			i = distribution(rng);
-		}
-		return std::move(arr);
+		counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 	}
 
-	template <typename Float_t, size_t N> 
-	inline std::array<Float_t, N>&& GetFloatArray_Impl(Float_t min, Float_t max)
+	//Forwards to the global engine and counts each step against the API that asked for it.
+	struct StatsEngine
 	{
-		std::array<Float_t, N>&& arr{};
-		std::uniform_real_distribution<Float_t> distribution(min, max);
-		for (auto& i : arr) {
-			i = distribution(rng);
+		using result_type = Engine::result_type;
+
+		static constexpr result_type min() { return Engine::min(); }
+		static constexpr result_type max() { return Engine::max(); }
+
+		Engine* engine;
+		StatsBlock* block;
+		std::size_t api;
+
+		inline result_type operator()()
+		{
+			Bump(block->steps[api]);
+			return (*engine)();
 		}
-		return std::move(arr);
-	}
+	};
+
+	using GlobalEngine = StatsEngine;
 
-	template <typename Float_t>
-	inline Float_t GetFloat_Impl(Float_t min, Float_t max)
+	inline static StatsEngine& Use(Api api)
 	{
-		std::uniform_real_distribution<Float_t> dis{ min, max };
-		return dis(rng);
+		thread_local StatsEngine wrapper{ &Get().rng, &LocalStats(), 0 };
+		wrapper.api = static_cast<std::size_t>(api);
+		Bump(wrapper.block->calls[wrapper.api]);
+		return wrapper;
 	}
 
-	template <typename Float_t>
-	inline Float_t GetFloat_Normal_Impl(Float_t mean, Float_t stddev = static_cast<Float_t>(1.0))
+	inline static void CountRejection()
 	{
-		std::normal_distribution<Float_t> dis{ mean, stddev };
-		return dis(rng);
+		Bump(LocalStats().rejections);
 	}
 
-	inline std::string GetString_Impl(char begin, char end, const size_t length)
+	inline static void CountReseed()
 	{
-		std::uniform_int_distribution<std::int16_t> dis{ begin, end };
-		std::string str;
-		str.resize(length + 1);
-		for (size_t i = 0; i < length + 1; i++) {
-			str[i] = static_cast<char>(dis(rng));
-		}
-		return std::move(str);
+		Bump(LocalStats().reseeds);
 	}
 
-	inline std::string GetString_Impl(std::string_view charset, const size_t length)
+	//Reseeds in forked children are kept apart from the thread blocks: the child only has the forking
+	//thread, and another parent thread may have held the registry mutex at the time of the fork.
+	inline static std::atomic<std::uint64_t> forkReseeds{ 0 };
+
+	inline static void CountForkReseed() noexcept
 	{
-		std::uniform_int_distribution<size_t> dis{ 0, charset.length()-1 };
-		std::string str;
-		str.resize(length + 1);
-		for (size_t i = 0; i < length + 1; i++) {
-			str[i] = charset[dis(rng)];
-		}
-		return std::move(str);
+		Bump(forkReseeds);
 	}
-public:
+#else
+	using GlobalEngine = Engine;
+
 	/// <summary>
-	/// Generates a random integer of chosen size between begin and end (inclusive).
-	/// Uses a uniform distribution.
+	/// Engine used by a global API call. With RANDOM_ENABLE_STATS defined this also counts the call.
 	/// </summary>
-	/// <param name="begin"></param>
-	/// <param name="end"></param>
-	/// <returns></returns>
-	template<class Int_t>
-	inline static Int_t GetInt(Int_t begin, Int_t end)
+	inline static Engine& Use(Api) noexcept
 	{
-		return Get().GetInt_Impl(begin, end);
+		return Get().rng;
 	}
 
-	/// <summary>
-	/// Generates a random integer of word size between 0 and t (inclusive).
-	/// Uses a binomial distribution with a probability of p.
-	/// </summary>
-	/// <param name="t"></param>
-	/// <param name="p"></param>
-	/// <returns></returns>
-	template<class Int_t>
-	inline static Int_t GetIntBinomial(Int_t t, double p)
+	inline static void CountRejection() noexcept {}
+	inline static void CountReseed() noexcept {}
+	inline static void CountForkReseed() noexcept {}
+#endif
+
+#ifdef RANDOM_ENABLE_PROFILER
+#ifndef RANDOM_PROFILER_PERIOD
+#define RANDOM_PROFILER_PERIOD 64
+#endif
+#ifndef RANDOM_PROFILER_SLOTS
+#define RANDOM_PROFILER_SLOTS 4096
+#endif
+	static_assert((RANDOM_PROFILER_SLOTS & (RANDOM_PROFILER_SLOTS - 1)) == 0, "RANDOM_PROFILER_SLOTS must be a power of two");
+
+	//One call site in the open-addressed profile table. A slot is claimed once with a CAS on state
+	//and never released, so lookups and updates need no lock.
+	struct alignas(64) ProfileSlot
+	{
+		std::atomic<std::uint32_t> state{ 0 };
+		std::uint32_t line = 0;
+		const char* file = nullptr;
+		const char* function = nullptr;
+		std::atomic<std::uint64_t> samples{ 0 };
+		std::atomic<std::uint64_t> cycles{ 0 };
+		std::atomic<std::uint64_t> draws{ 0 };
+	};
+
+	struct ProfileTable
+	{
+		ProfileSlot slots[RANDOM_PROFILER_SLOTS];
+		std::atomic<std::uint64_t> dropped{ 0 };
+	};
+
+	inline static ProfileTable& Profiler()
 	{
-		return Get().GetInt_Binomial_Impl(t, p);
+		static ProfileTable* table = new ProfileTable();
+		return *table;
 	}
 
-	/// <summary>
-	/// Generates a random unsigned 8-bit integer between 0 and 255 (inclusive).
-	/// Uses a uniform distribution.
-	/// </summary>
-	/// <param name="begin"></param>
-	/// <param name="end"></param>
-	/// <returns></returns>
-	inline static unsigned char GetByte()
+	inline static std::uint64_t Cycles() noexcept
 	{
-		return static_cast<unsigned char>(GetInt<int16_t>(0, 255));
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
 	}
 
-	/// <summary>
-	/// Generates a random float between min and max (exclusive).
-	/// Uses a uniform distribution.
-	/// </summary>
-	/// <param name="min"></param>
-	/// <param name="max"></param>
-	/// <returns></returns>
-	template<typename Float_t>
-	inline static Float_t GetFloat(Float_t min, Float_t max)
+	//Hashes the file name by content, since the same file can reach the table through a different
+	//pointer from every translation unit that includes it.
+	inline static std::uint64_t HashSite(const CallSite& site) noexcept
 	{
-		return Get().GetFloat_Impl(min, max);
+		std::uint64_t hash = 0xcbf29ce484222325ull;
+		for (const char* c = site.file; *c != '\0'; ++c) {
+			hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3ull;
+		}
+		return HashStep(hash, site.line);
 	}
 
-	/// <summary>
-	/// Generates a random float between min and max (exclusive).
-	/// Uses a uniform distribution.
-	/// </summary>
-	/// <param name="min"></param>
-	/// <param name="max"></param>
-	/// <returns></returns>
-	template<typename Float_t>
-	inline static Float_t GetFloatNormal(Float_t mean, Float_t stddev = static_cast<Float_t>(1.0))
+	inline static ProfileSlot* FindSlot(const CallSite& site)
 	{
-		return Get().GetFloat_Normal_Impl(mean, stddev);
+		ProfileTable& table = Profiler();
+		const std::uint64_t hash = HashSite(site);
+		for (std::size_t probe = 0; probe < RANDOM_PROFILER_SLOTS; probe++) {
+			ProfileSlot& slot = table.slots[(hash + probe) & (RANDOM_PROFILER_SLOTS - 1)];
+			std::uint32_t state = slot.state.load(std::memory_order_acquire);
+			if (state == 0) {
+				if (slot.state.compare_exchange_strong(state, 1, std::memory_order_acq_rel)) {
+					slot.line = site.line;
+					slot.file = site.file;
+					slot.function = site.function;
+					slot.state.store(2, std::memory_order_release);
+					return &slot;
+				}
+			}
+			while (state == 1) {
+				state = slot.state.load(std::memory_order_acquire);
+			}
+			if (slot.line == site.line && (slot.file == site.file || std::strcmp(slot.file, site.file) == 0)) {
+				return &slot;
+			}
+		}
+		table.dropped.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
 	}
 
+	//Times one call in every RANDOM_PROFILER_PERIOD on each thread and charges it to the call site.
+	class CallProfiler
+	{
+	public:
+		explicit CallProfiler(const CallSite& site) noexcept
+		{
+			thread_local std::uint32_t countdown = RANDOM_PROFILER_PERIOD;
+			if (--countdown != 0) {
+				return;
+			}
+			countdown = RANDOM_PROFILER_PERIOD;
+			this->site = &site;
+			startEngine = Get().rng;
+			start = Cycles();
+		}
+
+		~CallProfiler()
+		{
+			if (!site) {
+				return;
+			}
+			const std::uint64_t cycles = Cycles() - start;
+			if (ProfileSlot* slot = FindSlot(*site)) {
+				slot->samples.fetch_add(1, std::memory_order_relaxed);
+				slot->cycles.fetch_add(cycles, std::memory_order_relaxed);
+				slot->draws.fetch_add(static_cast<std::uint64_t>(Get().rng - startEngine), std::memory_order_relaxed);
+			}
+		}
+
+		CallProfiler(const CallProfiler&) = delete;
+		CallProfiler& operator=(const CallProfiler&) = delete;
+	private:
+		const CallSite* site = nullptr;
+		std::uint64_t start = 0;
+		Engine startEngine;
+	};
+#endif
+
 	/// <summary>
-	/// Generates a random double between 0.0 and 1.0 (exclusive), and returns true if the double is
-	/// less than pct.
+	/// Seeds an engine from the operating system. On Linux this is a single getrandom call,
+	/// elsewhere it falls back to std::random_device.
+	/// Define RANDOM_FAST_SEED to instead mix one word of OS entropy (a non-blocking getrandom call,
+	/// or std::random_device where that doesn't exist) with the clocks, pid, thread id and ASLR addresses.
 	/// </summary>
-	/// <param name="pct">The percentage chance that the function returns true.</param>
-	/// <returns></returns>
-	inline static bool Chance(double pct)
+	template<typename Engine_t>
+	inline static void SeedFromEntropy(Engine_t& engine)
 	{
-		pct = std::clamp(pct, 0.0, 1.0);
-		return (Get().GetFloat_Impl(0.0, 1.0)) < pct;
+#if defined(RANDOM_FAST_SEED)
+		std::uint64_t word = 0;
+		bool haveWord = false;
+#ifdef RANDOM_HAS_GETRANDOM
+		haveWord = getrandom(&word, sizeof(word), GRND_NONBLOCK) == static_cast<ssize_t>(sizeof(word));
+#endif
+		if (!haveWord) {
+			//without OS entropy, processes started in the same clock tick would get nearly the same seed
+			std::random_device device;
+			const std::uint64_t high = device();
+			const std::uint64_t low = device();
+			word = (high << 32) ^ low;
+		}
+		std::uint64_t h = HashStep(0, word);
+		h = HashStep(h, static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()));
+		h = HashStep(h, static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+#if defined(__unix__) || defined(__APPLE__)
+		h = HashStep(h, static_cast<std::uint64_t>(::getpid()));
+#endif
+		h = HashStep(h, static_cast<std::uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+		h = HashStep(h, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(&word)));
+		h = HashStep(h, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(&Get)));
+		engine.seed(h, HashStep(h, word));
+		return;
+#else
+#ifdef RANDOM_HAS_GETRANDOM
+		std::uint64_t words[2];
+		if (getrandom(words, sizeof(words), 0) == static_cast<ssize_t>(sizeof(words))) {
+			engine.seed(words[0], words[1]);
+			return;
+		}
+#endif
+		pcg_extras::seed_seq_from<std::random_device> seed_source;
+		engine.seed(seed_source);
+#endif
 	}
 
-	/// <summary>
-	/// Generates a random integer between 1 and d (inclusive), and returns true if the integer is
-	/// less than or equal to n.
-	/// </summary>
-	/// <param name="n">Numerator of the fraction.</param>
-	/// <param name="d">Denominator of the fraction.</param>
-	/// <returns></returns>
-	inline static bool Chance(int n, int d)
+	template <typename Engine_t, typename T>
+	inline static T GetInt_Impl(Engine_t& engine, T begin, T end)
 	{
-		n = std::clamp(n, 0, d);
-		return Get().GetInt_Impl(1, d) <= n;
+		std::uniform_int_distribution<T> dis(begin, end);
+		return dis(engine);
 	}
 
-	/// <summary>
-	/// Shuffles a container between iterators begin and end.
-	/// </summary>
-	/// <typeparam name="Iter_t">Iterator type</typeparam>
-	/// <param name="begin">Start iterator.</param>
-	/// <param name="end">End iterator.</param>
-	template<typename Iter_t>
-	inline static void Shuffle(Iter_t begin, Iter_t end)
+	template <typename Engine_t, typename T>
+	inline static T GetInt_Binomial_Impl(Engine_t& engine, T t, double p)
 	{
-		std::shuffle(begin, end, Get().rng);
+		std::binomial_distribution<T> dis{ t, p };
+		return dis(engine);
 	}
 
-	/// <summary>
-	/// Shuffles a container.
-	/// </summary>
-	/// <typeparam name="Container_t">Iterator type</typeparam>
-	/// <param name="container">Reference to container to be shuffled.</param>
-	template<typename Container_t>
-	inline static void Shuffle(Container_t& container)
+	template <typename T, size_t N, typename Engine_t>
+	inline static std::array<T, N> GetIntArray_Impl(Engine_t& engine, T begin, T end)
 	{
-		std::shuffle(container.begin(), container.end(), Get().rng);
+		std::array<T, N> arr{};
+		std::uniform_int_distribution<T> distribution{ begin, end };
+		for (auto& i : arr) {
+			i = distribution(engine);
+		}
+		return arr;
 	}
 
-	/// <summary>
-	/// Copies a container, then shuffles and returns the copy.
-	/// </summary>
-	/// <typeparam name="Container_t">Iterator type</typeparam>
-	/// <param name="container">Constant reference to container to be copied and shuffled.</param>
-	template<typename Container_t>
-	inline static Container_t&& ShuffleCopy(const Container_t& container)
+	template <typename Float_t, size_t N, typename Engine_t>
+	inline static std::array<Float_t, N> GetFloatArray_Impl(Engine_t& engine, Float_t min, Float_t max)
 	{
-		Container_t copy = container;
-		std::shuffle(copy.begin(), copy.end(), Get().rng);
-		return std::move(copy);
+		std::array<Float_t, N> arr{};
+		std::uniform_real_distribution<Float_t> distribution(min, max);
+		for (auto& i : arr) {
+			i = distribution(engine);
+		}
+		return arr;
 	}
 
-	/// <summary>
-	/// Generates a string of length "length" + 1 with characters between begin and end (inclusive).
-	/// </summary>
-	/// <param name="begin"></param>
-	/// <param name="end"></param>
-	/// <param name="length"></param>
-	/// <returns></returns>
-	inline static std::string GetString(char begin, char end, const size_t length)
+	template <typename T, typename Alloc_t, typename Engine_t>
+	inline static std::vector<T, Alloc_t> GetIntVector_Impl(Engine_t& engine, size_t count, T begin, T end, const Alloc_t& alloc)
 	{
-		return Get().GetString_Impl(begin, end, length);
+		std::vector<T, Alloc_t> vec(count, alloc);
+		std::uniform_int_distribution<T> distribution{ begin, end };
+		for (auto& i : vec) {
+			i = distribution(engine);
+		}
+		return vec;
 	}
 
-	/// <summary>
-	/// Generates a string of length "length" + 1 with a defined charset.
-	/// </summary>
-	/// <param name="begin"></param>
-	/// <param name="end"></param>
-	/// <param name="length"></param>
-	/// <returns></returns>
-	inline static std::string GetString(std::string_view charset, const size_t length)
+	template <typename Float_t, typename Alloc_t, typename Engine_t>
+	inline static std::vector<Float_t, Alloc_t> GetFloatVector_Impl(Engine_t& engine, size_t count, Float_t min, Float_t max, const Alloc_t& alloc)
 	{
-		return Get().GetString_Impl(charset, length);
+		std::vector<Float_t, Alloc_t> vec(count, alloc);
+		std::uniform_real_distribution<Float_t> distribution(min, max);
+		for (auto& i : vec) {
+			i = distribution(engine);
+		}
+		return vec;
 	}
 
-	/// <summary>
-	/// Reseeds the generator engine with a new seed.
-	/// </summary>
-	/// <param name="value">Seed</param>
-	template<typename... Args>
-	inline static void Seed(Args&& ...args)
+	//"inside-out" Fisher-Yates: element i lands in a random slot j <= i, and whatever was in j moves to i,
+	//so the output is copied and shuffled in a single pass. Earlier output slots are read back, which is
+	//why out must be random access rather than an output iterator.
+	template <typename Engine_t, typename InIter_t, typename RandomIter_t>
+	inline static RandomIter_t ShuffleInto_Impl(Engine_t& engine, InIter_t first, InIter_t last, RandomIter_t out)
 	{
-		Get().rng.seed(args...);
+		static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<RandomIter_t>::iterator_category>,
+			"ShuffleInto needs a random access destination, not an output iterator");
+		using Dist_t = std::uniform_int_distribution<size_t>;
+		if (first == last) {
+			return out;
+		}
+		Dist_t dis;
+		out[0] = *first;
+		size_t i = 1;
+		for (++first; first != last; ++first, ++i) {
+			const size_t j = dis(engine, typename Dist_t::param_type(0, i));
+			if (j != i) {
+				out[i] = std::move(out[j]);
+			}
+			out[j] = *first;
+		}
+		return out + i;
 	}
 
-	inline static void Seed()
+	//Takes the top 8 bits of one engine output when the engine covers its whole result type.
+	template <typename Engine_t>
+	inline static unsigned char GetByte_Impl(Engine_t& engine)
 	{
-		pcg_extras::seed_seq_from<std::random_device> seed_source;
-		Get().rng.seed(seed_source);
+		using Result_t = typename Engine_t::result_type;
+		constexpr int digits = std::numeric_limits<Result_t>::digits;
+		if constexpr (Engine_t::min() == 0 && Engine_t::max() == std::numeric_limits<Result_t>::max() && digits >= 8) {
+			return static_cast<unsigned char>(engine() >> (digits - 8));
+		}
+		else {
+			return static_cast<unsigned char>(GetInt_Impl<Engine_t, std::int16_t>(engine, 0, 255));
+		}
 	}
-public:
-	/// <summary>
-	/// Generates N random integers between begin and end and returns them in a std::array
-	/// by r-value reference.
-	/// </summary>
-	/// <param name="begin"></param>
-	/// <param name="end"></param>
-	/// <returns></returns>
-	template<size_t N, typename Int_t>
-	inline static std::array<Int_t, N>&& GetIntArray(Int_t begin, Int_t end) {
-		return std::move(Get().GetIntArray_Impl<Int_t, N>(begin, end));
+
+	//Bulk bytes come from a BufferedEngine seeded from the caller's engine. It generates whole blocks
+	//of 32-bit words on independent lanes, with no distribution per value.
+	using ByteEngine = BufferedEngine<>;
+
+	template <typename Engine_t>
+	inline static ByteEngine MakeByteEngine(Engine_t& engine)
+	{
+		//drawn one statement at a time: the order operands are evaluated in is unspecified
+		const std::uint64_t stateHigh = static_cast<std::uint64_t>(engine());
+		const std::uint64_t stateLow = static_cast<std::uint64_t>(engine());
+		const std::uint64_t streamHigh = static_cast<std::uint64_t>(engine());
+		const std::uint64_t streamLow = static_cast<std::uint64_t>(engine());
+		return ByteEngine((stateHigh << 32) ^ stateLow, (streamHigh << 32) ^ streamLow);
 	}
 
-	/// <summary>
-	/// Generates N random floats between begin and end and returns them in a std::array
-	/// by r-value reference.
-	/// </summary>
-	/// <param name="begin"></param>
-	/// <param name="end"></param>
-	/// <returns></returns>
-	template<size_t N, typename Float_t>
-	inline static std::array<Float_t, N>&& GetFloatArray(Float_t begin, Float_t end) {
-		return std::move(Get().GetFloatArray_Impl<Float_t, N>(begin, end));
+	template <typename Engine_t>
+	inline static void FillBytes_Impl(Engine_t& engine, void* data, size_t size)
+	{
+		unsigned char* bytes = static_cast<unsigned char*>(data);
+		if (size < 64) {
+			for (size_t i = 0; i < size; i++) {
+				bytes[i] = GetByte_Impl(engine);
+			}
+			return;
+		}
+		ByteEngine bulk = MakeByteEngine(engine);
+		std::uint32_t block[1024];
+		while (size > 0) {
+			const size_t n = std::min(size, sizeof(block));
+			bulk.generate(block, (n + 3) / 4);
+			std::memcpy(bytes, block, n);
+			bytes += n;
+			size -= n;
+		}
+	}
+
+	template <typename Engine_t, typename Float_t>
+	inline static Float_t GetFloat_Impl(Engine_t& engine, Float_t min, Float_t max)
+	{
+		std::uniform_real_distribution<Float_t> dis{ min, max };
+		return dis(engine);
+	}
+
+	template <typename Engine_t, typename Float_t>
+	inline static Float_t GetFloat_Normal_Impl(Engine_t& engine, Float_t mean, Float_t stddev = static_cast<Float_t>(1.0))
+	{
+		std::normal_distribution<Float_t> dis{ mean, stddev };
+		return dis(engine);
+	}
+
+	template <typename Engine_t>
+	inline static std::string GetString_Impl(Engine_t& engine, char begin, char end, const size_t length)
+	{
+		std::uniform_int_distribution<std::int16_t> dis{ begin, end };
+		std::string str;
+		str.resize(length + 1);
+		for (size_t i = 0; i < length + 1; i++) {
+			str[i] = static_cast<char>(dis(engine));
+		}
+		return str;
+	}
+
+	template <typename Engine_t>
+	inline static std::string GetString_Impl(Engine_t& engine, std::string_view charset, const size_t length)
+	{
+		std::uniform_int_distribution<size_t> dis{ 0, charset.length()-1 };
+		std::string str;
+		str.resize(length + 1);
+		for (size_t i = 0; i < length + 1; i++) {
+			str[i] = charset[dis(engine)];
+		}
+		return str;
+	}
+
+	template<typename Engine_t>
+	static constexpr int EngineBits()
+	{
+		static_assert(Engine_t::min() == 0, "Engine must produce values starting at 0.");
+		static_assert((Engine_t::max() & (Engine_t::max() + 1)) == 0, "Engine must produce full-width values.");
+		int bits = 0;
+		for (auto m = Engine_t::max(); m != 0; m >>= 1) {
+			++bits;
+		}
+		return bits;
+	}
+
+	template<typename Engine_t>
+	inline static std::uint32_t Bits32(Engine_t& engine)
+	{
+		constexpr int bits = EngineBits<Engine_t>();
+		if constexpr (bits >= 32) {
+			return static_cast<std::uint32_t>(static_cast<std::uint64_t>(engine()) >> (bits - 32));
+		} else {
+			std::uint32_t value = 0;
+			for (int filled = 0; filled < 32; filled += bits) {
+				value = (value << bits) | static_cast<std::uint32_t>(engine());
+			}
+			return value;
+		}
+	}
+
+	template<typename Engine_t>
+	inline static std::uint64_t Bits64(Engine_t& engine)
+	{
+		constexpr int bits = EngineBits<Engine_t>();
+		if constexpr (bits >= 64) {
+			return static_cast<std::uint64_t>(engine());
+		} else {
+			return (static_cast<std::uint64_t>(Bits32(engine)) << 32) | Bits32(engine);
+		}
+	}
+
+	//Converts raw engine bits straight to [0, 1) without going through std::generate_canonical.
+	template<typename Float_t, typename Engine_t>
+	inline static Float_t UnitFloat(Engine_t& engine)
+	{
+		if constexpr (sizeof(Float_t) <= sizeof(float)) {
+			return static_cast<Float_t>(Bits32(engine) >> 8) * static_cast<Float_t>(0x1p-24);
+		} else {
+			return static_cast<Float_t>(Bits64(engine) >> 11) * static_cast<Float_t>(0x1p-53);
+		}
+	}
+
+	//Same as UnitFloat, but never returns 0, so the result is always safe to pass to std::log.
+	template<typename Engine_t>
+	inline static double UnitFloatOpen(Engine_t& engine)
+	{
+		return (static_cast<double>(Bits64(engine) >> 11) + 0.5) * 0x1p-53;
+	}
+
+	//Layer tables for Marsaglia and Tsang's 128-layer Ziggurat.
+	struct ZigguratTables
+	{
+		static constexpr double R = 3.442619855899;
+		std::uint32_t k[128];
+		double w[128];
+		double f[128];
+
+		ZigguratTables()
+		{
+			constexpr double m1 = 2147483648.0;
+			constexpr double vn = 9.91256303526217e-3;
+			double dn = R, tn = R;
+			const double q = vn / std::exp(-0.5 * dn * dn);
+			k[0] = static_cast<std::uint32_t>(dn / q * m1);
+			k[1] = 0;
+			w[0] = q / m1;
+			w[127] = dn / m1;
+			f[0] = 1.0;
+			f[127] = std::exp(-0.5 * dn * dn);
+			for (int i = 126; i >= 1; i--) {
+				dn = std::sqrt(-2.0 * std::log(vn / dn + std::exp(-0.5 * dn * dn)));
+				k[i + 1] = static_cast<std::uint32_t>(dn / tn * m1);
+				tn = dn;
+				f[i] = std::exp(-0.5 * dn * dn);
+				w[i] = dn / m1;
+			}
+		}
+	};
+
+	inline static const ZigguratTables& Ziggurat() noexcept
+	{
+		static const ZigguratTables tables;
+		return tables;
+	}
+
+	template<typename Engine_t>
+	inline static double StandardNormal(Engine_t& engine)
+	{
+		const ZigguratTables& z = Ziggurat();
+		for (;;) {
+			//The layer and the value come from separate bits. Taking both from one 32-bit word
+			//correlates the output with the layer (Doornik, 2005).
+			const std::uint64_t random = Bits64(engine);
+			const std::uint32_t bits = static_cast<std::uint32_t>(random >> 32);
+			const std::int32_t hz = static_cast<std::int32_t>(bits);
+			const std::uint32_t iz = static_cast<std::uint32_t>(random >> 25) & 127u;
+			const std::uint32_t magnitude = hz < 0 ? 0u - bits : bits;
+			const double x = static_cast<double>(hz) * z.w[iz];
+			if (magnitude < z.k[iz]) {
+				return x;
+			}
+			if (iz == 0) {
+				double tx, ty;
+				do {
+					tx = -std::log(UnitFloatOpen(engine)) / ZigguratTables::R;
+					ty = -std::log(UnitFloatOpen(engine));
+				} while (ty + ty < tx * tx);
+				return hz > 0 ? ZigguratTables::R + tx : -ZigguratTables::R - tx;
+			}
+			if (z.f[iz] + UnitFloat<double>(engine) * (z.f[iz - 1] - z.f[iz]) < std::exp(-0.5 * x * x)) {
+				return x;
+			}
+			CountRejection();
+		}
+	}
+
+	template<typename Derived_t, typename Result_t>
+	class Sampler
+	{
+	public:
+		using result_type = Result_t;
+
+		/// <summary>
+		/// Draws a single value using the global generator.
+		/// </summary>
+		/// <returns></returns>
+		inline Result_t operator()(RANDOM_CALL_SITE_ONLY) const
+		{
+			RANDOM_PROFILE_CALL;
+			return Self()(Use(Api::Samplers));
+		}
+
+		/// <summary>
+		/// Fills the range between iterators begin and end using the global generator.
+		/// </summary>
+		/// <param name="begin">Start iterator.</param>
+		/// <param name="end">End iterator.</param>
+		template<typename Iter_t>
+		inline void Fill(Iter_t begin, Iter_t end RANDOM_CALL_SITE) const
+		{
+			RANDOM_PROFILE_CALL;
+			Fill(Use(Api::Samplers), begin, end);
+		}
+
+		/// <summary>
+		/// Fills a container using the global generator.
+		/// </summary>
+		/// <param name="container">Reference to container to be filled.</param>
+		template<typename Container_t>
+		inline void Fill(Container_t& container RANDOM_CALL_SITE) const
+		{
+			RANDOM_PROFILE_CALL;
+			Fill(Use(Api::Samplers), container.begin(), container.end());
+		}
+
+		/// <summary>
+		/// Fills the range between iterators begin and end using the supplied engine.
+		/// </summary>
+		/// <param name="engine">Engine to draw from.</param>
+		/// <param name="begin">Start iterator.</param>
+		/// <param name="end">End iterator.</param>
+		template<typename Engine_t, typename Iter_t>
+		inline void Fill(Engine_t& engine, Iter_t begin, Iter_t end) const
+		{
+			const Derived_t& self = Self();
+			for (; begin != end; ++begin) {
+				*begin = self(engine);
+			}
+		}
+	private:
+		inline const Derived_t& Self() const noexcept
+		{
+			return static_cast<const Derived_t&>(*this);
+		}
+	};
+
+	static constexpr double TwoPi = 6.283185307179586476925286766559;
+	static constexpr size_t ShapeBlock = 256;
+
+	template<typename Engine_t, typename Float_t>
+	inline static void FillUnit(Engine_t& engine, Float_t* out, size_t count)
+	{
+		for (size_t i = 0; i < count; i++) {
+			out[i] = UnitFloat<Float_t>(engine);
+		}
+	}
+
+	//The shape generators below draw a block of uniforms first, then transform the whole block in a
+	//branch-free loop so the transform can be vectorized.
+	template<typename Engine_t, typename Float_t>
+	static void GetPointsInDisk_Impl(Engine_t& engine, Float_t* x, Float_t* y, size_t count, Float_t radius)
+	{
+		Float_t u[ShapeBlock], v[ShapeBlock];
+		for (size_t start = 0; start < count; start += ShapeBlock) {
+			const size_t n = std::min(ShapeBlock, count - start);
+			FillUnit(engine, u, n);
+			FillUnit(engine, v, n);
+			for (size_t i = 0; i < n; i++) {
+				const Float_t r = radius * std::sqrt(u[i]);
+				const Float_t theta = static_cast<Float_t>(TwoPi) * v[i];
+				x[start + i] = r * std::cos(theta);
+				y[start + i] = r * std::sin(theta);
+			}
+		}
+	}
+
+	template<typename Engine_t, typename Float_t>
+	static void GetPointsOnCircle_Impl(Engine_t& engine, Float_t* x, Float_t* y, size_t count, Float_t radius)
+	{
+		Float_t u[ShapeBlock];
+		for (size_t start = 0; start < count; start += ShapeBlock) {
+			const size_t n = std::min(ShapeBlock, count - start);
+			FillUnit(engine, u, n);
+			for (size_t i = 0; i < n; i++) {
+				const Float_t theta = static_cast<Float_t>(TwoPi) * u[i];
+				x[start + i] = radius * std::cos(theta);
+				y[start + i] = radius * std::sin(theta);
+			}
+		}
+	}
+
+	template<typename Engine_t, typename Float_t>
+	static void GetPointsOnSphere_Impl(Engine_t& engine, Float_t* x, Float_t* y, Float_t* z, size_t count,
+		Float_t radius)
+	{
+		Float_t u[ShapeBlock], v[ShapeBlock];
+		for (size_t start = 0; start < count; start += ShapeBlock) {
+			const size_t n = std::min(ShapeBlock, count - start);
+			FillUnit(engine, u, n);
+			FillUnit(engine, v, n);
+			for (size_t i = 0; i < n; i++) {
+				const Float_t h = static_cast<Float_t>(1.0) - static_cast<Float_t>(2.0) * u[i];
+				const Float_t r = std::sqrt(std::max(static_cast<Float_t>(0.0), static_cast<Float_t>(1.0) - h * h));
+				const Float_t phi = static_cast<Float_t>(TwoPi) * v[i];
+				x[start + i] = radius * r * std::cos(phi);
+				y[start + i] = radius * r * std::sin(phi);
+				z[start + i] = radius * h;
+			}
+		}
+	}
+
+	template<typename Engine_t, typename Float_t>
+	static void GetPointsInBall_Impl(Engine_t& engine, Float_t* x, Float_t* y, Float_t* z, size_t count,
+		Float_t radius)
+	{
+		Float_t u[ShapeBlock], v[ShapeBlock], w[ShapeBlock];
+		for (size_t start = 0; start < count; start += ShapeBlock) {
+			const size_t n = std::min(ShapeBlock, count - start);
+			FillUnit(engine, u, n);
+			FillUnit(engine, v, n);
+			FillUnit(engine, w, n);
+			for (size_t i = 0; i < n; i++) {
+				const Float_t h = static_cast<Float_t>(1.0) - static_cast<Float_t>(2.0) * u[i];
+				const Float_t r = std::sqrt(std::max(static_cast<Float_t>(0.0), static_cast<Float_t>(1.0) - h * h));
+				const Float_t phi = static_cast<Float_t>(TwoPi) * v[i];
+				const Float_t scale = radius * std::cbrt(w[i]);
+				x[start + i] = scale * r * std::cos(phi);
+				y[start + i] = scale * r * std::sin(phi);
+				z[start + i] = scale * h;
+			}
+		}
+	}
+
+	template<typename Engine_t, typename Float_t, size_t D>
+	static void GetPointsInTriangle_Impl(Engine_t& engine, Float_t* const (&out)[D], size_t count,
+		const std::array<Float_t, D>& a, const std::array<Float_t, D>& b, const std::array<Float_t, D>& c)
+	{
+		Float_t u[ShapeBlock], v[ShapeBlock];
+		for (size_t start = 0; start < count; start += ShapeBlock) {
+			const size_t n = std::min(ShapeBlock, count - start);
+			FillUnit(engine, u, n);
+			FillUnit(engine, v, n);
+			//Points that land in the far half of the parallelogram are folded back into the triangle.
+			for (size_t i = 0; i < n; i++) {
+				const bool fold = u[i] + v[i] > static_cast<Float_t>(1.0);
+				u[i] = fold ? static_cast<Float_t>(1.0) - u[i] : u[i];
+				v[i] = fold ? static_cast<Float_t>(1.0) - v[i] : v[i];
+			}
+			for (size_t d = 0; d < D; d++) {
+				const Float_t ab = b[d] - a[d], ac = c[d] - a[d];
+				Float_t* o = out[d] + start;
+				for (size_t i = 0; i < n; i++) {
+					o[i] = a[d] + u[i] * ab + v[i] * ac;
+				}
+			}
+		}
+	}
+
+	template<typename Engine_t, typename Float_t>
+	static void GetUnitQuaternions_Impl(Engine_t& engine, Float_t* x, Float_t* y, Float_t* z, Float_t* w,
+		size_t count)
+	{
+		//Shoemake's method: uniform over SO(3) from three uniforms, no rejection.
+		Float_t u1[ShapeBlock], u2[ShapeBlock], u3[ShapeBlock];
+		for (size_t start = 0; start < count; start += ShapeBlock) {
+			const size_t n = std::min(ShapeBlock, count - start);
+			FillUnit(engine, u1, n);
+			FillUnit(engine, u2, n);
+			FillUnit(engine, u3, n);
+			for (size_t i = 0; i < n; i++) {
+				const Float_t s1 = std::sqrt(static_cast<Float_t>(1.0) - u1[i]);
+				const Float_t s2 = std::sqrt(u1[i]);
+				const Float_t t1 = static_cast<Float_t>(TwoPi) * u2[i];
+				const Float_t t2 = static_cast<Float_t>(TwoPi) * u3[i];
+				x[start + i] = s1 * std::sin(t1);
+				y[start + i] = s1 * std::cos(t1);
+				z[start + i] = s2 * std::sin(t2);
+				w[start + i] = s2 * std::cos(t2);
+			}
+		}
+	}
+
+	//One step of the stateless hash: fold a value into the state, take a pcg32 LCG step and
+	//finish with pcg's 64-bit RXS M XS output permutation. Every step is a bijection.
+	inline static std::uint64_t HashStep(std::uint64_t h, std::uint64_t value) noexcept
+	{
+		h = (h ^ value) * 6364136223846793005ull + 1442695040888963407ull;
+		return pcg_detail::rxs_m_xs_mixin<std::uint64_t, std::uint64_t>::output(h);
+	}
+
+	inline static std::uint64_t Hash_Impl(std::uint64_t seed, std::uint64_t id, std::uint64_t tick, std::uint64_t salt) noexcept
+	{
+		return HashStep(HashStep(HashStep(HashStep(0, seed), id), tick), salt);
+	}
+
+	inline static std::uint64_t MulHi64(std::uint64_t a, std::uint64_t b) noexcept
+	{
+#if defined(__SIZEOF_INT128__)
+		return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+		const std::uint64_t aLo = a & 0xFFFFFFFFu, aHi = a >> 32;
+		const std::uint64_t bLo = b & 0xFFFFFFFFu, bHi = b >> 32;
+		const std::uint64_t lo = aLo * bLo;
+		const std::uint64_t mid1 = aHi * bLo + (lo >> 32);
+		const std::uint64_t mid2 = aLo * bHi + (mid1 & 0xFFFFFFFFu);
+		return aHi * bHi + (mid1 >> 32) + (mid2 >> 32);
+#endif
+	}
+
+	template<typename Int_t>
+	inline static Int_t HashToRange(std::uint64_t h, Int_t begin, Int_t end) noexcept
+	{
+		using Unsigned_t = std::make_unsigned_t<Int_t>;
+		const std::uint64_t range = static_cast<std::uint64_t>(static_cast<Unsigned_t>(static_cast<Unsigned_t>(end) - static_cast<Unsigned_t>(begin)));
+		const std::uint64_t offset = range == ~std::uint64_t(0) ? h : MulHi64(h, range + 1);
+		return static_cast<Int_t>(static_cast<Unsigned_t>(static_cast<Unsigned_t>(begin) + static_cast<Unsigned_t>(offset)));
+	}
+
+	template<typename Float_t>
+	inline static Float_t HashToUnit(std::uint64_t h) noexcept
+	{
+		if constexpr (sizeof(Float_t) <= sizeof(float)) {
+			return static_cast<Float_t>(h >> 40) * static_cast<Float_t>(0x1p-24);
+		} else {
+			return static_cast<Float_t>(h >> 11) * static_cast<Float_t>(0x1p-53);
+		}
+	}
+public:
+	/// <summary>
+	/// Generates a random integer of chosen size between begin and end (inclusive).
+	/// Uses a uniform distribution.
+	/// </summary>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <returns></returns>
+	template<class Int_t>
+	inline static Int_t GetInt(Int_t begin, Int_t end RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetInt_Impl(Use(Api::GetInt), begin, end);
+	}
+
+	/// <summary>
+	/// Generates a random integer of word size between 0 and t (inclusive).
+	/// Uses a binomial distribution with a probability of p.
+	/// </summary>
+	/// <param name="t"></param>
+	/// <param name="p"></param>
+	/// <returns></returns>
+	template<class Int_t>
+	inline static Int_t GetIntBinomial(Int_t t, double p RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetInt_Binomial_Impl(Use(Api::GetIntBinomial), t, p);
+	}
+
+	/// <summary>
+	/// Generates a random unsigned 8-bit integer between 0 and 255 (inclusive).
+	/// Uses the top 8 bits of a single engine output.
+	/// </summary>
+	/// <returns></returns>
+	inline static unsigned char GetByte(RANDOM_CALL_SITE_ONLY)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetByte_Impl(Use(Api::GetByte));
+	}
+
+	/// <summary>
+	/// Fills size bytes at data with random bytes. Large fills are generated a block at a time
+	/// by a multi-lane engine seeded from the global one.
+	/// </summary>
+	/// <param name="data">Destination.</param>
+	/// <param name="size">Number of bytes.</param>
+	inline static void FillBytes(void* data, size_t size RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		FillBytes_Impl(Use(Api::GetByte), data, size);
+	}
+
+	/// <summary>
+	/// Generates a random float between min and max (exclusive).
+	/// Uses a uniform distribution.
+	/// </summary>
+	/// <param name="min"></param>
+	/// <param name="max"></param>
+	/// <returns></returns>
+	template<typename Float_t>
+	inline static Float_t GetFloat(Float_t min, Float_t max RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetFloat_Impl(Use(Api::GetFloat), min, max);
+	}
+
+	/// <summary>
+	/// Generates a random float between min and max (exclusive).
+	/// Uses a uniform distribution.
+	/// </summary>
+	/// <param name="min"></param>
+	/// <param name="max"></param>
+	/// <returns></returns>
+	template<typename Float_t>
+	inline static Float_t GetFloatNormal(Float_t mean, Float_t stddev = static_cast<Float_t>(1.0) RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetFloat_Normal_Impl(Use(Api::GetFloatNormal), mean, stddev);
+	}
+
+	/// <summary>
+	/// Generates a random double between 0.0 and 1.0 (exclusive), and returns true if the double is
+	/// less than pct.
+	/// </summary>
+	/// <param name="pct">The percentage chance that the function returns true.</param>
+	/// <returns></returns>
+	inline static bool Chance(double pct RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		pct = std::clamp(pct, 0.0, 1.0);
+		return (GetFloat_Impl(Use(Api::Chance), 0.0, 1.0)) < pct;
+	}
+
+	/// <summary>
+	/// Generates a random integer between 1 and d (inclusive), and returns true if the integer is
+	/// less than or equal to n.
+	/// </summary>
+	/// <param name="n">Numerator of the fraction.</param>
+	/// <param name="d">Denominator of the fraction.</param>
+	/// <returns></returns>
+	inline static bool Chance(int n, int d RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		n = std::clamp(n, 0, d);
+		return GetInt_Impl(Use(Api::Chance), 1, d) <= n;
+	}
+
+	/// <summary>
+	/// Shuffles a container between iterators begin and end.
+	/// </summary>
+	/// <typeparam name="Iter_t">Iterator type</typeparam>
+	/// <param name="begin">Start iterator.</param>
+	/// <param name="end">End iterator.</param>
+	template<typename Iter_t>
+	inline static void Shuffle(Iter_t begin, Iter_t end RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		std::shuffle(begin, end, Use(Api::Shuffle));
+	}
+
+	/// <summary>
+	/// Shuffles a container.
+	/// </summary>
+	/// <typeparam name="Container_t">Iterator type</typeparam>
+	/// <param name="container">Reference to container to be shuffled.</param>
+	template<typename Container_t>
+	inline static void Shuffle(Container_t& container RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		std::shuffle(container.begin(), container.end(), Use(Api::Shuffle));
+	}
+
+	/// <summary>
+	/// Copies a container, then shuffles and returns the copy.
+	/// </summary>
+	/// <typeparam name="Container_t">Iterator type</typeparam>
+	/// <param name="container">Constant reference to container to be copied and shuffled.</param>
+	template<typename Container_t>
+	inline static Container_t ShuffleCopy(const Container_t& container RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		Container_t copy = container;
+		std::shuffle(copy.begin(), copy.end(), Use(Api::Shuffle));
+		return copy;
+	}
+
+	/// <summary>
+	/// Writes a shuffled copy of [first, last) to out in one pass, without modifying the source.
+	/// The source only needs input iterators. out must be a random access iterator to at least
+	/// std::distance(first, last) assignable elements: elements already written are moved, so an output
+	/// iterator such as std::back_inserter won't do.
+	/// </summary>
+	/// <param name="first">Start of the source range.</param>
+	/// <param name="last">End of the source range.</param>
+	/// <param name="out">Start of the random access destination range.</param>
+	/// <returns>Iterator past the last element written.</returns>
+	template<typename InIter_t, typename RandomIter_t>
+	inline static RandomIter_t ShuffleInto(InIter_t first, InIter_t last, RandomIter_t out RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return ShuffleInto_Impl(Use(Api::Shuffle), first, last, out);
+	}
+
+	/// <summary>
+	/// Generates a string of length "length" + 1 with characters between begin and end (inclusive).
+	/// </summary>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <param name="length"></param>
+	/// <returns></returns>
+	inline static std::string GetString(char begin, char end, const size_t length RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetString_Impl(Use(Api::GetString), begin, end, length);
+	}
+
+	/// <summary>
+	/// Generates a string of length "length" + 1 with a defined charset.
+	/// </summary>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <param name="length"></param>
+	/// <returns></returns>
+	inline static std::string GetString(std::string_view charset, const size_t length RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetString_Impl(Use(Api::GetString), charset, length);
+	}
+
+	/// <summary>
+	/// Reseeds the generator engine with a new seed.
+	/// </summary>
+	/// <param name="value">Seed</param>
+	template<typename... Args>
+	inline static void Seed(Args&& ...args)
+	{
+		CountReseed();
+		Get().rng.seed(args...);
+	}
+
+	inline static void Seed()
+	{
+		CountReseed();
+		SeedFromEntropy(Get().rng);
+	}
+public:
+	/// <summary>
+	/// Generates N random integers between begin and end and returns them in a std::array.
+	/// </summary>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <returns></returns>
+	template<size_t N, typename Int_t>
+	inline static std::array<Int_t, N> GetIntArray(Int_t begin, Int_t end RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetIntArray_Impl<Int_t, N>(Use(Api::Arrays), begin, end);
+	}
+
+	/// <summary>
+	/// Generates N random floats between begin and end and returns them in a std::array.
+	/// </summary>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <returns></returns>
+	template<size_t N, typename Float_t>
+	inline static std::array<Float_t, N> GetFloatArray(Float_t begin, Float_t end RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetFloatArray_Impl<Float_t, N>(Use(Api::Arrays), begin, end);
+	}
+
+	/// <summary>
+	/// Generates count random integers between begin and end (inclusive) into a std::vector
+	/// allocated with alloc.
+	/// </summary>
+	/// <param name="count">Number of values.</param>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <param name="alloc">Allocator for the vector.</param>
+	/// <returns></returns>
+	template<typename Int_t, typename Alloc_t = std::allocator<Int_t>, typename = std::enable_if_t<!std::is_pointer_v<Alloc_t>>>
+	inline static std::vector<Int_t, Alloc_t> GetIntVector(size_t count, Int_t begin, Int_t end, const Alloc_t& alloc = Alloc_t() RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetIntVector_Impl<Int_t>(Use(Api::Arrays), count, begin, end, alloc);
+	}
+
+	/// <summary>
+	/// Generates count random floats between min and max (exclusive) into a std::vector
+	/// allocated with alloc.
+	/// </summary>
+	/// <param name="count">Number of values.</param>
+	/// <param name="min"></param>
+	/// <param name="max"></param>
+	/// <param name="alloc">Allocator for the vector.</param>
+	/// <returns></returns>
+	template<typename Float_t, typename Alloc_t = std::allocator<Float_t>, typename = std::enable_if_t<!std::is_pointer_v<Alloc_t>>>
+	inline static std::vector<Float_t, Alloc_t> GetFloatVector(size_t count, Float_t min, Float_t max, const Alloc_t& alloc = Alloc_t() RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetFloatVector_Impl<Float_t>(Use(Api::Arrays), count, min, max, alloc);
+	}
+
+#ifdef RANDOM_HAS_PMR
+	/// <summary>
+	/// Generates count random integers between begin and end (inclusive) into a std::pmr::vector
+	/// that allocates from resource, e.g. a std::pmr::monotonic_buffer_resource arena.
+	/// </summary>
+	/// <param name="count">Number of values.</param>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <param name="resource">Memory resource for the vector.</param>
+	/// <returns></returns>
+	template<typename Int_t>
+	inline static std::pmr::vector<Int_t> GetIntVector(size_t count, Int_t begin, Int_t end, std::pmr::memory_resource* resource RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetIntVector_Impl<Int_t>(Use(Api::Arrays), count, begin, end, std::pmr::polymorphic_allocator<Int_t>(resource));
+	}
+
+	/// <summary>
+	/// Generates count random floats between min and max (exclusive) into a std::pmr::vector
+	/// that allocates from resource.
+	/// </summary>
+	/// <param name="count">Number of values.</param>
+	/// <param name="min"></param>
+	/// <param name="max"></param>
+	/// <param name="resource">Memory resource for the vector.</param>
+	/// <returns></returns>
+	template<typename Float_t>
+	inline static std::pmr::vector<Float_t> GetFloatVector(size_t count, Float_t min, Float_t max, std::pmr::memory_resource* resource RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return GetFloatVector_Impl<Float_t>(Use(Api::Arrays), count, min, max, std::pmr::polymorphic_allocator<Float_t>(resource));
+	}
+#endif
+
+	/// <summary>
+	/// Generates count points uniformly inside a disk centered on the origin.
+	/// Coordinates are written to separate arrays.
+	/// </summary>
+	/// <param name="x">Pointer to count x coordinates.</param>
+	/// <param name="y">Pointer to count y coordinates.</param>
+	/// <param name="count">Number of points.</param>
+	/// <param name="radius">Radius of the disk.</param>
+	template<typename Float_t>
+	inline static void GetPointsInDisk(Float_t* x, Float_t* y, size_t count, Float_t radius = static_cast<Float_t>(1.0) RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		GetPointsInDisk_Impl(Use(Api::Shapes), x, y, count, radius);
+	}
+
+	/// <summary>
+	/// Generates count points uniformly on a circle centered on the origin.
+	/// With the default radius these are random 2D unit vectors.
+	/// </summary>
+	/// <param name="x">Pointer to count x coordinates.</param>
+	/// <param name="y">Pointer to count y coordinates.</param>
+	/// <param name="count">Number of points.</param>
+	/// <param name="radius">Radius of the circle.</param>
+	template<typename Float_t>
+	inline static void GetPointsOnCircle(Float_t* x, Float_t* y, size_t count, Float_t radius = static_cast<Float_t>(1.0) RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		GetPointsOnCircle_Impl(Use(Api::Shapes), x, y, count, radius);
+	}
+
+	/// <summary>
+	/// Generates count points uniformly on the surface of a sphere centered on the origin.
+	/// With the default radius these are random 3D unit vectors.
+	/// </summary>
+	/// <param name="x">Pointer to count x coordinates.</param>
+	/// <param name="y">Pointer to count y coordinates.</param>
+	/// <param name="z">Pointer to count z coordinates.</param>
+	/// <param name="count">Number of points.</param>
+	/// <param name="radius">Radius of the sphere.</param>
+	template<typename Float_t>
+	inline static void GetPointsOnSphere(Float_t* x, Float_t* y, Float_t* z, size_t count,
+		Float_t radius = static_cast<Float_t>(1.0) RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		GetPointsOnSphere_Impl(Use(Api::Shapes), x, y, z, count, radius);
+	}
+
+	/// <summary>
+	/// Generates count points uniformly inside a ball centered on the origin.
+	/// </summary>
+	/// <param name="x">Pointer to count x coordinates.</param>
+	/// <param name="y">Pointer to count y coordinates.</param>
+	/// <param name="z">Pointer to count z coordinates.</param>
+	/// <param name="count">Number of points.</param>
+	/// <param name="radius">Radius of the ball.</param>
+	template<typename Float_t>
+	inline static void GetPointsInBall(Float_t* x, Float_t* y, Float_t* z, size_t count,
+		Float_t radius = static_cast<Float_t>(1.0) RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		GetPointsInBall_Impl(Use(Api::Shapes), x, y, z, count, radius);
+	}
+
+	/// <summary>
+	/// Generates count points uniformly inside the 2D triangle abc.
+	/// </summary>
+	/// <param name="x">Pointer to count x coordinates.</param>
+	/// <param name="y">Pointer to count y coordinates.</param>
+	/// <param name="count">Number of points.</param>
+	/// <param name="a">First vertex.</param>
+	/// <param name="b">Second vertex.</param>
+	/// <param name="c">Third vertex.</param>
+	template<typename Float_t>
+	inline static void GetPointsInTriangle(Float_t* x, Float_t* y, size_t count,
+		const std::array<Float_t, 2>& a, const std::array<Float_t, 2>& b, const std::array<Float_t, 2>& c RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		Float_t* const out[2] = { x, y };
+		GetPointsInTriangle_Impl(Use(Api::Shapes), out, count, a, b, c);
+	}
+
+	/// <summary>
+	/// Generates count points uniformly inside the 3D triangle abc.
+	/// </summary>
+	/// <param name="x">Pointer to count x coordinates.</param>
+	/// <param name="y">Pointer to count y coordinates.</param>
+	/// <param name="z">Pointer to count z coordinates.</param>
+	/// <param name="count">Number of points.</param>
+	/// <param name="a">First vertex.</param>
+	/// <param name="b">Second vertex.</param>
+	/// <param name="c">Third vertex.</param>
+	template<typename Float_t>
+	inline static void GetPointsInTriangle(Float_t* x, Float_t* y, Float_t* z, size_t count,
+		const std::array<Float_t, 3>& a, const std::array<Float_t, 3>& b, const std::array<Float_t, 3>& c RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		Float_t* const out[3] = { x, y, z };
+		GetPointsInTriangle_Impl(Use(Api::Shapes), out, count, a, b, c);
+	}
+
+	/// <summary>
+	/// Generates count random rotations as unit quaternions, uniformly distributed over all orientations.
+	/// </summary>
+	/// <param name="x">Pointer to count x components.</param>
+	/// <param name="y">Pointer to count y components.</param>
+	/// <param name="z">Pointer to count z components.</param>
+	/// <param name="w">Pointer to count w components.</param>
+	/// <param name="count">Number of quaternions.</param>
+	template<typename Float_t>
+	inline static void GetUnitQuaternions(Float_t* x, Float_t* y, Float_t* z, Float_t* w, size_t count RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		GetUnitQuaternions_Impl(Use(Api::Shapes), x, y, z, w, count);
+	}
+
+	/// <summary>
+	/// Stateless hash of (seed, id, tick, salt) to a uniformly distributed 64-bit value. It does not
+	/// touch any generator state, so results don't depend on call order and can be computed in
+	/// parallel, e.g. per entity per tick.
+	/// </summary>
+	/// <param name="seed">Global seed.</param>
+	/// <param name="id">Entity or item id.</param>
+	/// <param name="tick">Time step or frame number.</param>
+	/// <param name="salt">Extra value to tell apart several decisions made for the same id and tick.</param>
+	/// <returns></returns>
+	inline static std::uint64_t Hash(std::uint64_t seed, std::uint64_t id, std::uint64_t tick = 0, std::uint64_t salt = 0 RANDOM_CALL_SITE) noexcept
+	{
+		RANDOM_PROFILE_CALL;
+		return Hash_Impl(seed, id, tick, salt);
+	}
+
+	/// <summary>
+	/// Stateless integer between begin and end (inclusive) derived from Hash(seed, id, tick, salt).
+	/// </summary>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <param name="seed">Global seed.</param>
+	/// <param name="id">Entity or item id.</param>
+	/// <param name="tick">Time step or frame number.</param>
+	/// <param name="salt">Extra value to tell apart several decisions made for the same id and tick.</param>
+	/// <returns></returns>
+	template<typename Int_t>
+	inline static Int_t HashInt(Int_t begin, Int_t end, std::uint64_t seed, std::uint64_t id, std::uint64_t tick = 0,
+		std::uint64_t salt = 0 RANDOM_CALL_SITE) noexcept
+	{
+		RANDOM_PROFILE_CALL;
+		return HashToRange(Hash_Impl(seed, id, tick, salt), begin, end);
+	}
+
+	/// <summary>
+	/// Stateless float between min and max (exclusive) derived from Hash(seed, id, tick, salt).
+	/// </summary>
+	/// <param name="min"></param>
+	/// <param name="max"></param>
+	/// <param name="seed">Global seed.</param>
+	/// <param name="id">Entity or item id.</param>
+	/// <param name="tick">Time step or frame number.</param>
+	/// <param name="salt">Extra value to tell apart several decisions made for the same id and tick.</param>
+	/// <returns></returns>
+	template<typename Float_t>
+	inline static Float_t HashFloat(Float_t min, Float_t max, std::uint64_t seed, std::uint64_t id, std::uint64_t tick = 0,
+		std::uint64_t salt = 0 RANDOM_CALL_SITE) noexcept
+	{
+		RANDOM_PROFILE_CALL;
+		return min + (max - min) * HashToUnit<Float_t>(Hash_Impl(seed, id, tick, salt));
+	}
+
+	/// <summary>
+	/// Stateless version of Chance(pct): returns true with probability pct, derived from
+	/// Hash(seed, id, tick, salt).
+	/// </summary>
+	/// <param name="pct">The percentage chance that the function returns true.</param>
+	/// <param name="seed">Global seed.</param>
+	/// <param name="id">Entity or item id.</param>
+	/// <param name="tick">Time step or frame number.</param>
+	/// <param name="salt">Extra value to tell apart several decisions made for the same id and tick.</param>
+	/// <returns></returns>
+	inline static bool HashChance(double pct, std::uint64_t seed, std::uint64_t id, std::uint64_t tick = 0,
+		std::uint64_t salt = 0 RANDOM_CALL_SITE) noexcept
+	{
+		RANDOM_PROFILE_CALL;
+		return HashToUnit<double>(Hash_Impl(seed, id, tick, salt)) < std::clamp(pct, 0.0, 1.0);
+	}
+
+	/// <summary>
+	/// Bulk version of Hash for count ids. The loop has no dependencies between ids, so it vectorizes.
+	/// </summary>
+	/// <param name="seed">Global seed.</param>
+	/// <param name="ids">Pointer to count ids.</param>
+	/// <param name="count">Number of ids.</param>
+	/// <param name="tick">Time step or frame number.</param>
+	/// <param name="salt">Extra value to tell apart several decisions made for the same id and tick.</param>
+	/// <param name="out">Pointer to count results.</param>
+	inline static void Hash(std::uint64_t seed, const std::uint64_t* ids, size_t count, std::uint64_t tick,
+		std::uint64_t salt, std::uint64_t* out RANDOM_CALL_SITE) noexcept
+	{
+		RANDOM_PROFILE_CALL;
+		const std::uint64_t h = HashStep(0, seed);
+		for (size_t i = 0; i < count; i++) {
+			out[i] = HashStep(HashStep(HashStep(h, ids[i]), tick), salt);
+		}
+	}
+
+	/// <summary>
+	/// Bulk version of HashInt for count ids.
+	/// </summary>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <param name="seed">Global seed.</param>
+	/// <param name="ids">Pointer to count ids.</param>
+	/// <param name="count">Number of ids.</param>
+	/// <param name="tick">Time step or frame number.</param>
+	/// <param name="salt">Extra value to tell apart several decisions made for the same id and tick.</param>
+	/// <param name="out">Pointer to count results.</param>
+	template<typename Int_t>
+	inline static void HashInt(Int_t begin, Int_t end, std::uint64_t seed, const std::uint64_t* ids, size_t count,
+		std::uint64_t tick, std::uint64_t salt, Int_t* out RANDOM_CALL_SITE) noexcept
+	{
+		RANDOM_PROFILE_CALL;
+		const std::uint64_t h = HashStep(0, seed);
+		for (size_t i = 0; i < count; i++) {
+			out[i] = HashToRange(HashStep(HashStep(HashStep(h, ids[i]), tick), salt), begin, end);
+		}
+	}
+
+	/// <summary>
+	/// Bulk version of HashFloat for count ids.
+	/// </summary>
+	/// <param name="min"></param>
+	/// <param name="max"></param>
+	/// <param name="seed">Global seed.</param>
+	/// <param name="ids">Pointer to count ids.</param>
+	/// <param name="count">Number of ids.</param>
+	/// <param name="tick">Time step or frame number.</param>
+	/// <param name="salt">Extra value to tell apart several decisions made for the same id and tick.</param>
+	/// <param name="out">Pointer to count results.</param>
+	template<typename Float_t>
+	inline static void HashFloat(Float_t min, Float_t max, std::uint64_t seed, const std::uint64_t* ids, size_t count,
+		std::uint64_t tick, std::uint64_t salt, Float_t* out RANDOM_CALL_SITE) noexcept
+	{
+		RANDOM_PROFILE_CALL;
+		const std::uint64_t h = HashStep(0, seed);
+		const Float_t scale = max - min;
+		for (size_t i = 0; i < count; i++) {
+			out[i] = min + scale * HashToUnit<Float_t>(HashStep(HashStep(HashStep(h, ids[i]), tick), salt));
+		}
+	}
+
+	/// <summary>
+	/// Bulk version of HashChance for count ids.
+	/// </summary>
+	/// <param name="pct">The percentage chance that each result is true.</param>
+	/// <param name="seed">Global seed.</param>
+	/// <param name="ids">Pointer to count ids.</param>
+	/// <param name="count">Number of ids.</param>
+	/// <param name="tick">Time step or frame number.</param>
+	/// <param name="salt">Extra value to tell apart several decisions made for the same id and tick.</param>
+	/// <param name="out">Pointer to count results.</param>
+	inline static void HashChance(double pct, std::uint64_t seed, const std::uint64_t* ids, size_t count,
+		std::uint64_t tick, std::uint64_t salt, bool* out RANDOM_CALL_SITE) noexcept
+	{
+		RANDOM_PROFILE_CALL;
+		const std::uint64_t h = HashStep(0, seed);
+		pct = std::clamp(pct, 0.0, 1.0);
+		for (size_t i = 0; i < count; i++) {
+			out[i] = HashToUnit<double>(HashStep(HashStep(HashStep(h, ids[i]), tick), salt)) < pct;
+		}
+	}
+public:
+	/// <summary>
+	/// Poisson distribution sampler. The constants for the chosen mean are computed once on
+	/// construction, so a sampler should be kept and reused rather than built for every draw.
+	/// Small means use the multiplication method, larger means use Hormann's PTRS rejection.
+	/// </summary>
+	/// <typeparam name="Int_t">Integer type of the result.</typeparam>
+	template<typename Int_t = int>
+	class Poisson : public Sampler<Poisson<Int_t>, Int_t>
+	{
+	public:
+		using Sampler<Poisson<Int_t>, Int_t>::operator();
+
+		/// <summary>
+		/// Creates a sampler for a Poisson distribution.
+		/// </summary>
+		/// <param name="mean">Mean of the distribution. Must not be negative.</param>
+		explicit Poisson(double mean = 1.0) : mean(mean)
+		{
+			assert(mean >= 0.0);
+			if (mean < 10.0) {
+				expMean = std::exp(-mean);
+			} else {
+				logMean = std::log(mean);
+				b = 0.931 + 2.53 * std::sqrt(mean);
+				a = -0.059 + 0.02483 * b;
+				logInvAlpha = std::log(1.1239 + 1.1328 / (b - 3.4));
+				vr = 0.9277 - 3.6224 / (b - 2.0);
+			}
+		}
+
+		inline double Mean() const noexcept { return mean; }
+
+		template<typename Engine_t>
+		inline Int_t operator()(Engine_t& engine) const
+		{
+			if (mean < 10.0) {
+				Int_t k = 0;
+				double p = UnitFloat<double>(engine);
+				while (p > expMean) {
+					++k;
+					p *= UnitFloat<double>(engine);
+				}
+				return k;
+			}
+			for (;;) {
+				const double u = UnitFloat<double>(engine) - 0.5;
+				const double v = UnitFloatOpen(engine);
+				const double us = 0.5 - std::abs(u);
+				const double k = std::floor((2.0 * a / us + b) * u + mean + 0.43);
+				if (us >= 0.07 && v <= vr) {
+					return static_cast<Int_t>(k);
+				}
+				if (k < 0.0 || (us < 0.013 && v > us)) {
+					CountRejection();
+					continue;
+				}
+				if (std::log(v) + logInvAlpha - std::log(a / (us * us) + b)
+					<= -mean + k * logMean - std::lgamma(k + 1.0)) {
+					return static_cast<Int_t>(k);
+				}
+				CountRejection();
+			}
+		}
+	private:
+		double mean;
+		double expMean = 0.0;
+		double logMean = 0.0, a = 0.0, b = 0.0, logInvAlpha = 0.0, vr = 0.0;
+	};
+
+	/// <summary>
+	/// Gamma distribution sampler using the Marsaglia-Tsang method. Shapes below 1 are
+	/// handled by sampling with shape + 1 and scaling by U^(1/shape).
+	/// </summary>
+	/// <typeparam name="Float_t">Floating-point type of the result.</typeparam>
+	template<typename Float_t = double>
+	class Gamma : public Sampler<Gamma<Float_t>, Float_t>
+	{
+	public:
+		using Sampler<Gamma<Float_t>, Float_t>::operator();
+
+		/// <summary>
+		/// Creates a sampler for a gamma distribution.
+		/// </summary>
+		/// <param name="shape">Shape (k) of the distribution. Must be positive.</param>
+		/// <param name="scale">Scale (theta) of the distribution. Must be positive.</param>
+		explicit Gamma(Float_t shape = static_cast<Float_t>(1.0), Float_t scale = static_cast<Float_t>(1.0))
+			: shape(shape), scale(scale)
+		{
+			assert(shape > 0 && scale > 0);
+			const double k = shape < 1 ? static_cast<double>(shape) + 1.0 : static_cast<double>(shape);
+			d = k - 1.0 / 3.0;
+			c = 1.0 / std::sqrt(9.0 * d);
+			invShape = shape < 1 ? 1.0 / static_cast<double>(shape) : 0.0;
+		}
+
+		inline Float_t Shape() const noexcept { return shape; }
+		inline Float_t Scale() const noexcept { return scale; }
+
+		template<typename Engine_t>
+		inline Float_t operator()(Engine_t& engine) const
+		{
+			for (;;) {
+				double x, v;
+				do {
+					x = StandardNormal(engine);
+					v = 1.0 + c * x;
+				} while (v <= 0.0);
+				v = v * v * v;
+				const double u = UnitFloatOpen(engine);
+				const double x2 = x * x;
+				if (u < 1.0 - 0.0331 * x2 * x2
+					|| std::log(u) < 0.5 * x2 + d * (1.0 - v + std::log(v))) {
+					double result = d * v;
+					if (invShape != 0.0) {
+						result *= std::pow(UnitFloatOpen(engine), invShape);
+					}
+					return static_cast<Float_t>(result * static_cast<double>(scale));
+				}
+				CountRejection();
+			}
+		}
+	private:
+		Float_t shape, scale;
+		double d, c, invShape;
+	};
+
+	/// <summary>
+	/// Beta distribution sampler, built from the ratio of two gamma variates.
+	/// </summary>
+	/// <typeparam name="Float_t">Floating-point type of the result.</typeparam>
+	template<typename Float_t = double>
+	class Beta : public Sampler<Beta<Float_t>, Float_t>
+	{
+	public:
+		using Sampler<Beta<Float_t>, Float_t>::operator();
+
+		/// <summary>
+		/// Creates a sampler for a beta distribution.
+		/// </summary>
+		/// <param name="alpha">First shape parameter. Must be positive.</param>
+		/// <param name="beta">Second shape parameter. Must be positive.</param>
+		explicit Beta(Float_t alpha = static_cast<Float_t>(1.0), Float_t beta = static_cast<Float_t>(1.0))
+			: x(alpha), y(beta)
+		{
+		}
+
+		inline Float_t Alpha() const noexcept { return x.Shape(); }
+		inline Float_t BetaParam() const noexcept { return y.Shape(); }
+
+		template<typename Engine_t>
+		inline Float_t operator()(Engine_t& engine) const
+		{
+			for (;;) {
+				const double gx = static_cast<double>(x(engine));
+				const double gy = static_cast<double>(y(engine));
+				if (gx + gy > 0.0) {
+					return static_cast<Float_t>(gx / (gx + gy));
+				}
+			}
+		}
+	private:
+		Gamma<Float_t> x, y;
+	};
+
+	/// <summary>
+	/// Geometric distribution sampler. Returns the number of failures before the first success
+	/// of a Bernoulli trial with probability p, matching std::geometric_distribution.
+	/// </summary>
+	/// <typeparam name="Int_t">Integer type of the result.</typeparam>
+	template<typename Int_t = int>
+	class Geometric : public Sampler<Geometric<Int_t>, Int_t>
+	{
+	public:
+		using Sampler<Geometric<Int_t>, Int_t>::operator();
+
+		/// <summary>
+		/// Creates a sampler for a geometric distribution.
+		/// </summary>
+		/// <param name="p">Probability of success of each trial. Must be in (0, 1].</param>
+		explicit Geometric(double p = 0.5) : p(p)
+		{
+			assert(p > 0.0 && p <= 1.0);
+			invLogQ = p < 1.0 ? 1.0 / std::log1p(-p) : 0.0;
+		}
+
+		inline double P() const noexcept { return p; }
+
+		template<typename Engine_t>
+		inline Int_t operator()(Engine_t& engine) const
+		{
+			if (invLogQ == 0.0) {
+				return 0;
+			}
+			const double k = std::floor(std::log(UnitFloatOpen(engine)) * invLogQ);
+			constexpr double limit = static_cast<double>(std::numeric_limits<Int_t>::max());
+			return k < limit ? static_cast<Int_t>(k) : std::numeric_limits<Int_t>::max();
+		}
+	private:
+		double p;
+		double invLogQ;
+	};
+
+	/// <summary>
+	/// Log-normal distribution sampler. Returns exp(m + s * N(0, 1)).
+	/// </summary>
+	/// <typeparam name="Float_t">Floating-point type of the result.</typeparam>
+	template<typename Float_t = double>
+	class LogNormal : public Sampler<LogNormal<Float_t>, Float_t>
+	{
+	public:
+		using Sampler<LogNormal<Float_t>, Float_t>::operator();
+
+		/// <summary>
+		/// Creates a sampler for a log-normal distribution.
+		/// </summary>
+		/// <param name="m">Mean of the underlying normal distribution.</param>
+		/// <param name="s">Standard deviation of the underlying normal distribution.</param>
+		explicit LogNormal(Float_t m = static_cast<Float_t>(0.0), Float_t s = static_cast<Float_t>(1.0))
+			: m(m), s(s)
+		{
+		}
+
+		inline Float_t M() const noexcept { return m; }
+		inline Float_t S() const noexcept { return s; }
+
+		template<typename Engine_t>
+		inline Float_t operator()(Engine_t& engine) const
+		{
+			return static_cast<Float_t>(std::exp(static_cast<double>(m)
+				+ static_cast<double>(s) * StandardNormal(engine)));
+		}
+	private:
+		Float_t m, s;
+	};
+
+	/// <summary>
+	/// Binomial distribution sampler. Uses inversion when the mode is small and Hormann's BTRD
+	/// rejection otherwise, so the cost of a draw does not grow with the number of trials.
+	/// </summary>
+	/// <typeparam name="Int_t">Integer type of the result.</typeparam>
+	template<typename Int_t = int>
+	class Binomial : public Sampler<Binomial<Int_t>, Int_t>
+	{
+	public:
+		using Sampler<Binomial<Int_t>, Int_t>::operator();
+
+		/// <summary>
+		/// Creates a sampler for a binomial distribution.
+		/// </summary>
+		/// <param name="t">Number of trials. Must not be negative.</param>
+		/// <param name="p">Probability of success of each trial. Must be in [0, 1].</param>
+		explicit Binomial(Int_t t = 1, double p = 0.5) : t(static_cast<std::int64_t>(t)), p(p)
+		{
+			assert(t >= 0 && p >= 0.0 && p <= 1.0);
+			flipped = p > 0.5;
+			const double q = flipped ? 1.0 - p : p;
+			const double n = static_cast<double>(this->t);
+			m = static_cast<std::int64_t>((n + 1.0) * q);
+			r = q / (1.0 - q);
+			if (m < 11) {
+				qn = std::pow(1.0 - q, n);
+				nr = (n + 1.0) * r;
+			} else {
+				nr = (n + 1.0) * r;
+				npq = n * q * (1.0 - q);
+				const double sqrtNpq = std::sqrt(npq);
+				b = 1.15 + 2.53 * sqrtNpq;
+				a = -0.0873 + 0.0248 * b + 0.01 * q;
+				c = n * q + 0.5;
+				alpha = (2.83 + 5.1 / b) * sqrtNpq;
+				vr = 0.92 - 4.2 / b;
+				urvr = 0.86 * vr;
+			}
+		}
+
+		inline Int_t T() const noexcept { return static_cast<Int_t>(t); }
+		inline double P() const noexcept { return p; }
+
+		template<typename Engine_t>
+		inline Int_t operator()(Engine_t& engine) const
+		{
+			const std::int64_t k = m < 11 ? Invert(engine) : Btrd(engine);
+			return static_cast<Int_t>(flipped ? t - k : k);
+		}
+	private:
+		std::int64_t t;
+		double p;
+		bool flipped;
+		std::int64_t m;
+		double r, nr;
+		double qn = 0.0;
+		double npq = 0.0, a = 0.0, b = 0.0, c = 0.0, alpha = 0.0, vr = 0.0, urvr = 0.0;
+
+		//Stirling series correction term for log(k!).
+		inline static double Fc(std::int64_t k)
+		{
+			static constexpr double table[10] = {
+				0.08106146679532726, 0.04134069595540929, 0.02767792568499834,
+				0.02079067210376509, 0.01664469118982119, 0.01387612882307075,
+				0.01189670994589177, 0.01041126526197209, 0.009255462182712733,
+				0.008330563433362871
+			};
+			if (k < 10) {
+				return table[k];
+			}
+			const double ikp1 = 1.0 / static_cast<double>(k + 1);
+			return (1.0 / 12.0 - (1.0 / 360.0 - (1.0 / 1260.0) * (ikp1 * ikp1)) * (ikp1 * ikp1)) * ikp1;
+		}
+
+		template<typename Engine_t>
+		inline std::int64_t Invert(Engine_t& engine) const
+		{
+			double u = UnitFloat<double>(engine);
+			double prob = qn;
+			std::int64_t x = 0;
+			while (u > prob && x < t) {
+				u -= prob;
+				++x;
+				const double next = (nr / static_cast<double>(x) - r) * prob;
+				//Past this point the remaining tail is lost in round-off.
+				if (next < std::numeric_limits<double>::epsilon() && next < prob) {
+					break;
+				}
+				prob = next;
+			}
+			return x;
+		}
+
+		template<typename Engine_t>
+		inline std::int64_t Btrd(Engine_t& engine) const
+		{
+			for (;;) {
+				double u;
+				double v = UnitFloat<double>(engine);
+				if (v <= urvr) {
+					u = v / vr - 0.43;
+					return static_cast<std::int64_t>(std::floor((2.0 * a / (0.5 - std::abs(u)) + b) * u + c));
+				}
+				if (v >= vr) {
+					u = UnitFloat<double>(engine) - 0.5;
+				} else {
+					u = v / vr - 0.93;
+					u = (u < 0.0 ? -0.5 : 0.5) - u;
+					v = UnitFloat<double>(engine) * vr;
+				}
+
+				const double us = 0.5 - std::abs(u);
+				const double kf = std::floor((2.0 * a / us + b) * u + c);
+				if (kf < 0.0 || kf > static_cast<double>(t)) {
+					CountRejection();
+					continue;
+				}
+				const std::int64_t k = static_cast<std::int64_t>(kf);
+				v = v * alpha / (a / (us * us) + b);
+				const double km = std::abs(static_cast<double>(k - m));
+				if (km <= 15.0) {
+					double f = 1.0;
+					if (m < k) {
+						for (std::int64_t i = m + 1; i <= k; ++i) {
+							f *= nr / static_cast<double>(i) - r;
+						}
+					} else if (m > k) {
+						for (std::int64_t i = k + 1; i <= m; ++i) {
+							v *= nr / static_cast<double>(i) - r;
+						}
+					}
+					if (v <= f) {
+						return k;
+					}
+					CountRejection();
+					continue;
+				}
+
+				v = std::log(v);
+				const double rho = (km / npq) * (((km / 3.0 + 0.625) * km + 1.0 / 6.0) / npq + 0.5);
+				const double tt = -km * km / (2.0 * npq);
+				if (v < tt - rho) {
+					return k;
+				}
+				if (v > tt + rho) {
+					CountRejection();
+					continue;
+				}
+				const double nm = static_cast<double>(t - m + 1);
+				const double h = (static_cast<double>(m) + 0.5) * std::log((static_cast<double>(m) + 1.0) / (r * nm))
+					+ Fc(m) + Fc(t - m);
+				const double nk = static_cast<double>(t - k + 1);
+				if (v <= h + (static_cast<double>(t) + 1.0) * std::log(nm / nk)
+					+ (static_cast<double>(k) + 0.5) * std::log(nk * r / (static_cast<double>(k) + 1.0))
+					- Fc(k) - Fc(t - k)) {
+					return k;
+				}
+				CountRejection();
+			}
+		}
+	};
+
+private:
+	//Validates the weights of Categorical and Multinomial in every build, since a bad table would
+	//otherwise give silently wrong draws. Returns their sum.
+	inline static double CheckWeights(const std::vector<double>& weights, const char* sampler)
+	{
+		double total = 0.0;
+		for (double w : weights) {
+			if (!(w >= 0.0) || !std::isfinite(w)) {
+				throw std::invalid_argument(std::string(sampler) + ": weights must be finite and non-negative");
+			}
+			total += w;
+		}
+		if (!(total > 0.0)) {
+			throw std::invalid_argument(std::string(sampler) + ": at least one weight must be positive");
+		}
+		if (!std::isfinite(total)) {
+			throw std::invalid_argument(std::string(sampler) + ": the weights overflow when summed");
+		}
+		return total;
+	}
+public:
+
+	/// <summary>
+	/// Multinomial sampler. Splits n trials into K buckets with the given weights and returns the
+	/// count for each bucket directly, using one conditional binomial draw per bucket instead of
+	/// one draw per trial.
+	/// </summary>
+	class Multinomial
+	{
+	public:
+		/// <summary>
+		/// Creates a sampler from a range of non-negative weights. The weights do not need to sum to 1.
+		/// Throws std::invalid_argument if a weight is negative or not finite, or no weight is positive.
+		/// </summary>
+		/// <param name="begin">Start iterator.</param>
+		/// <param name="end">End iterator.</param>
+		template<typename Iter_t>
+		Multinomial(Iter_t begin, Iter_t end)
+		{
+			for (; begin != end; ++begin) {
+				conditional.push_back(static_cast<double>(*begin));
+			}
+			CheckWeights(conditional, "Multinomial");
+			//Turn each weight into its probability given that no earlier bucket was chosen.
+			double tail = 0.0;
+			for (size_t i = conditional.size(); i-- > 0;) {
+				tail += conditional[i];
+				conditional[i] = tail > 0.0 ? std::min(conditional[i] / tail, 1.0) : 0.0;
+			}
+		}
+
+		Multinomial(std::initializer_list<double> weights)
+			: Multinomial(weights.begin(), weights.end())
+		{
+		}
+
+		inline size_t Size() const noexcept { return conditional.size(); }
+
+		/// <summary>
+		/// Distributes n trials across the buckets and writes Size() counts to out.
+		/// </summary>
+		/// <param name="engine">Engine to draw from.</param>
+		/// <param name="n">Number of trials.</param>
+		/// <param name="out">Output iterator receiving the count of each bucket.</param>
+		template<typename Engine_t, typename OutIter_t>
+		inline void Counts(Engine_t& engine, std::uint64_t n, OutIter_t out) const
+		{
+			std::int64_t remaining = static_cast<std::int64_t>(n);
+			for (double p : conditional) {
+				std::int64_t count = 0;
+				if (remaining > 0 && p > 0.0) {
+					count = p >= 1.0 ? remaining : Binomial<std::int64_t>(remaining, p)(engine);
+				}
+				remaining -= count;
+				*out = static_cast<std::uint64_t>(count);
+				++out;
+			}
+		}
+
+		/// <summary>
+		/// Distributes n trials across the buckets using the global generator and writes
+		/// Size() counts to out.
+		/// </summary>
+		/// <param name="n">Number of trials.</param>
+		/// <param name="out">Output iterator receiving the count of each bucket.</param>
+		template<typename OutIter_t>
+		inline void Counts(std::uint64_t n, OutIter_t out RANDOM_CALL_SITE) const
+		{
+			RANDOM_PROFILE_CALL;
+			Counts(Use(Api::Samplers), n, out);
+		}
+
+		/// <summary>
+		/// Distributes n trials across the buckets using the global generator.
+		/// </summary>
+		/// <param name="n">Number of trials.</param>
+		/// <returns>The count of each bucket.</returns>
+		inline std::vector<std::uint64_t> Counts(std::uint64_t n RANDOM_CALL_SITE) const
+		{
+			RANDOM_PROFILE_CALL;
+			std::vector<std::uint64_t> counts(conditional.size());
+			Counts(Use(Api::Samplers), n, counts.begin());
+			return counts;
+		}
+	private:
+		std::vector<double> conditional;
+	};
+
+	/// <summary>
+	/// Categorical sampler. Picks an index with probability proportional to its weight in O(1)
+	/// per draw using Vose's alias method.
+	/// </summary>
+	/// <typeparam name="Int_t">Integer type of the result.</typeparam>
+	template<typename Int_t = size_t>
+	class Categorical : public Sampler<Categorical<Int_t>, Int_t>
+	{
+	public:
+		using Sampler<Categorical<Int_t>, Int_t>::operator();
+
+		/// <summary>
+		/// Creates a sampler from a range of non-negative weights. At least one weight must be positive.
+		/// Throws std::invalid_argument if a weight is negative or not finite, no weight is positive, or
+		/// there are more than 2^32 - 1 weights.
+		/// </summary>
+		/// <param name="begin">Start iterator.</param>
+		/// <param name="end">End iterator.</param>
+		template<typename Iter_t>
+		Categorical(Iter_t begin, Iter_t end)
+		{
+			std::vector<double> scaled(begin, end);
+			const size_t k = scaled.size();
+			if (k > 0xFFFFFFFFu) {
+				throw std::invalid_argument("Categorical: at most 2^32 - 1 weights are supported");
+			}
+			const double total = CheckWeights(scaled, "Categorical");
+
+			threshold.resize(k);
+			alias.resize(k);
+			std::vector<std::uint32_t> small, large;
+			for (size_t i = 0; i < k; i++) {
+				scaled[i] *= static_cast<double>(k) / total;
+				(scaled[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+			}
+			while (!small.empty() && !large.empty()) {
+				const std::uint32_t s = small.back(), l = large.back();
+				small.pop_back();
+				threshold[s] = ToThreshold(scaled[s]);
+				alias[s] = l;
+				scaled[l] -= 1.0 - scaled[s];
+				if (scaled[l] < 1.0) {
+					large.pop_back();
+					small.push_back(l);
+				}
+			}
+			//Whatever is left is 1 up to round-off.
+			for (std::uint32_t i : large) {
+				threshold[i] = 0xFFFFFFFFu;
+				alias[i] = i;
+			}
+			for (std::uint32_t i : small) {
+				threshold[i] = 0xFFFFFFFFu;
+				alias[i] = i;
+			}
+		}
+
+		Categorical(std::initializer_list<double> weights)
+			: Categorical(weights.begin(), weights.end())
+		{
+		}
+
+		inline size_t Size() const noexcept { return alias.size(); }
+
+		template<typename Engine_t>
+		inline Int_t operator()(Engine_t& engine) const
+		{
+			const std::uint64_t bits = Bits64(engine);
+			const std::uint32_t i = static_cast<std::uint32_t>(((bits >> 32) * alias.size()) >> 32);
+			return static_cast<Int_t>(static_cast<std::uint32_t>(bits) < threshold[i] ? i : alias[i]);
+		}
+	private:
+		std::vector<std::uint32_t> threshold;
+		std::vector<std::uint32_t> alias;
+
+		inline static std::uint32_t ToThreshold(double p)
+		{
+			return p >= 1.0 ? 0xFFFFFFFFu : static_cast<std::uint32_t>(p * 0x1p32);
+		}
+	};
+
+	/// <summary>
+	/// Normal distribution sampler using the Ziggurat method. Unlike GetFloatNormal, it does not
+	/// build a std::normal_distribution for each call, which makes it the better choice for bulk draws.
+	/// </summary>
+	/// <typeparam name="Float_t">Floating-point type of the result.</typeparam>
+	template<typename Float_t = double>
+	class Normal : public Sampler<Normal<Float_t>, Float_t>
+	{
+	public:
+		using Sampler<Normal<Float_t>, Float_t>::operator();
+
+		/// <summary>
+		/// Creates a sampler for a normal distribution.
+		/// </summary>
+		/// <param name="mean">Mean of the distribution.</param>
+		/// <param name="stddev">Standard deviation of the distribution.</param>
+		explicit Normal(Float_t mean = static_cast<Float_t>(0.0), Float_t stddev = static_cast<Float_t>(1.0))
+			: mean(mean), stddev(stddev)
+		{
+		}
+
+		inline Float_t Mean() const noexcept { return mean; }
+		inline Float_t Stddev() const noexcept { return stddev; }
+
+		template<typename Engine_t>
+		inline Float_t operator()(Engine_t& engine) const
+		{
+			return mean + stddev * static_cast<Float_t>(StandardNormal(engine));
+		}
+	private:
+		Float_t mean, stddev;
+	};
+
+	/// <summary>
+	/// Multivariate normal sampler. The covariance matrix is factored once on construction, and
+	/// vectors are then generated in blocks: a block of standard normals is drawn first, then
+	/// multiplied by the Cholesky factor one row at a time.
+	/// </summary>
+	/// <typeparam name="Float_t">Floating-point type of the result.</typeparam>
+	template<typename Float_t = double>
+	class MultivariateNormal
+	{
+	public:
+		/// <summary>
+		/// Number of vectors generated per block by Fill.
+		/// </summary>
+		static constexpr size_t BlockSize = 256;
+
+		/// <summary>
+		/// Creates a sampler from a mean vector and a row-major covariance matrix.
+		/// Throws std::invalid_argument if the sizes don't match or the covariance matrix
+		/// is not symmetric positive definite.
+		/// </summary>
+		/// <param name="mean">Mean vector of length d.</param>
+		/// <param name="covariance">Row-major d by d covariance matrix.</param>
+		MultivariateNormal(const std::vector<double>& mean, const std::vector<double>& covariance)
+			: dim(mean.size()), mean(mean.begin(), mean.end()), factor(dim * (dim + 1) / 2)
+		{
+			if (covariance.size() != dim * dim) {
+				throw std::invalid_argument("MultivariateNormal: covariance must be a d by d matrix");
+			}
+			//Cholesky-Banachiewicz, computed in double and stored packed by row.
+			std::vector<double> l(dim * dim, 0.0);
+			for (size_t r = 0; r < dim; r++) {
+				for (size_t c = 0; c <= r; c++) {
+					if (covariance[r * dim + c] != covariance[c * dim + r]) {
+						throw std::invalid_argument("MultivariateNormal: covariance must be symmetric");
+					}
+					double sum = covariance[r * dim + c];
+					for (size_t k = 0; k < c; k++) {
+						sum -= l[r * dim + k] * l[c * dim + k];
+					}
+					if (r == c) {
+						if (!(sum > 0.0)) {
+							throw std::invalid_argument("MultivariateNormal: covariance must be positive definite");
+						}
+						l[r * dim + c] = std::sqrt(sum);
+					} else {
+						l[r * dim + c] = sum / l[c * dim + c];
+					}
+				}
+			}
+			for (size_t r = 0; r < dim; r++) {
+				for (size_t c = 0; c <= r; c++) {
+					factor[Packed(r, c)] = static_cast<Float_t>(l[r * dim + c]);
+				}
+			}
+		}
+
+		inline size_t Dimension() const noexcept { return dim; }
+
+		/// <summary>
+		/// Generates a single vector and writes its Dimension() values to out.
+		/// </summary>
+		/// <param name="engine">Engine to draw from.</param>
+		/// <param name="out">Pointer to Dimension() values.</param>
+		template<typename Engine_t>
+		inline void operator()(Engine_t& engine, Float_t* out) const
+		{
+			Fill(engine, out, 1);
+		}
+
+		/// <summary>
+		/// Generates a single vector using the global generator and writes its Dimension() values to out.
+		/// </summary>
+		/// <param name="out">Pointer to Dimension() values.</param>
+		inline void operator()(Float_t* out RANDOM_CALL_SITE) const
+		{
+			RANDOM_PROFILE_CALL;
+			Fill(Use(Api::Samplers), out, 1);
+		}
+
+		/// <summary>
+		/// Generates count vectors laid out as structure-of-arrays: component d of vector i is
+		/// written to out[d * count + i].
+		/// </summary>
+		/// <param name="engine">Engine to draw from.</param>
+		/// <param name="out">Pointer to Dimension() * count values.</param>
+		/// <param name="count">Number of vectors.</param>
+		template<typename Engine_t>
+		void Fill(Engine_t& engine, Float_t* out, size_t count) const
+		{
+			std::vector<Float_t> z(dim * BlockSize);
+			for (size_t start = 0; start < count; start += BlockSize) {
+				const size_t n = std::min(BlockSize, count - start);
+				for (size_t d = 0; d < dim; d++) {
+					Float_t* zd = z.data() + d * BlockSize;
+					for (size_t i = 0; i < n; i++) {
+						zd[i] = static_cast<Float_t>(StandardNormal(engine));
+					}
+				}
+				for (size_t r = 0; r < dim; r++) {
+					Float_t* row = out + r * count + start;
+					const Float_t mu = mean[r];
+					for (size_t i = 0; i < n; i++) {
+						row[i] = mu;
+					}
+					for (size_t c = 0; c <= r; c++) {
+						const Float_t l = factor[Packed(r, c)];
+						const Float_t* zc = z.data() + c * BlockSize;
+						for (size_t i = 0; i < n; i++) {
+							row[i] += l * zc[i];
+						}
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Generates count vectors using the global generator, laid out as structure-of-arrays.
+		/// </summary>
+		/// <param name="out">Pointer to Dimension() * count values.</param>
+		/// <param name="count">Number of vectors.</param>
+		inline void Fill(Float_t* out, size_t count RANDOM_CALL_SITE) const
+		{
+			RANDOM_PROFILE_CALL;
+			Fill(Use(Api::Samplers), out, count);
+		}
+	private:
+		size_t dim;
+		std::vector<Float_t> mean;
+		std::vector<Float_t> factor;
+
+		inline static size_t Packed(size_t r, size_t c) noexcept
+		{
+			return r * (r + 1) / 2 + c;
+		}
+	};
+
+	/// <summary>
+	/// Sobol low-discrepancy sequence using Joe and Kuo's direction numbers, with optional
+	/// hash-based Owen scrambling seeded from the generator. Supports up to MaxDimensions dimensions
+	/// and 2^32 points.
+	/// </summary>
+	/// <typeparam name="Float_t">Floating-point type of the coordinates.</typeparam>
+	template<typename Float_t = double>
+	class Sobol
+	{
+	public:
+		static constexpr size_t MaxDimensions = 37;
+
+		/// <summary>
+		/// Creates a Sobol sequence. Throws std::invalid_argument if dimensions is 0 or more
+		/// than MaxDimensions.
+		/// </summary>
+		/// <param name="dimensions">Number of dimensions of each point.</param>
+		/// <param name="scramble">Whether to Owen-scramble the sequence using the global generator.</param>
+		explicit Sobol(size_t dimensions, bool scramble = true RANDOM_CALL_SITE)
+			: directions(dimensions * 32), state(dimensions, 0), seeds(dimensions, 0)
+		{
+			if (dimensions == 0 || dimensions > MaxDimensions) {
+				throw std::invalid_argument("Sobol: unsupported number of dimensions");
+			}
+			for (size_t bit = 0; bit < 32; bit++) {
+				directions[bit] = 1u << (31 - bit);
+			}
+			for (size_t d = 1; d < dimensions; d++) {
+				const Polynomial& poly = Polynomials()[d - 1];
+				std::uint32_t* v = directions.data() + d * 32;
+				for (size_t bit = 0; bit < poly.s; bit++) {
+					v[bit] = static_cast<std::uint32_t>(poly.m[bit]) << (31 - bit);
+				}
+				for (size_t bit = poly.s; bit < 32; bit++) {
+					v[bit] = v[bit - poly.s] ^ (v[bit - poly.s] >> poly.s);
+					for (size_t k = 1; k < poly.s; k++) {
+						if ((poly.a >> (poly.s - 1 - k)) & 1u) {
+							v[bit] ^= v[bit - k];
+						}
+					}
+				}
+			}
+			if (scramble) {
+				RANDOM_PROFILE_CALL;
+				Rescramble(Use(Api::Samplers));
+			}
+		}
+
+		inline size_t Dimensions() const noexcept { return state.size(); }
+		inline std::uint64_t Index() const noexcept { return index; }
+
+		/// <summary>
+		/// Draws new scrambling seeds from the supplied engine. The sequence position is kept.
+		/// </summary>
+		/// <param name="engine">Engine to draw from.</param>
+		template<typename Engine_t>
+		inline void Rescramble(Engine_t& engine)
+		{
+			for (auto& seed : seeds) {
+				seed = Bits32(engine);
+			}
+			scrambled = true;
+		}
+
+		/// <summary>
+		/// Draws new scrambling seeds from the global generator. The sequence position is kept.
+		/// </summary>
+		inline void Rescramble(RANDOM_CALL_SITE_ONLY)
+		{
+			RANDOM_PROFILE_CALL;
+			Rescramble(Use(Api::Samplers));
+		}
+
+		/// <summary>
+		/// Moves the sequence to point number index.
+		/// </summary>
+		/// <param name="index">Index of the next point to generate.</param>
+		inline void Seek(std::uint64_t index)
+		{
+			this->index = index;
+			const std::uint32_t gray = static_cast<std::uint32_t>(index ^ (index >> 1));
+			for (size_t d = 0; d < state.size(); d++) {
+				std::uint32_t x = 0;
+				for (size_t bit = 0; bit < 32; bit++) {
+					if ((gray >> bit) & 1u) {
+						x ^= directions[d * 32 + bit];
+					}
+				}
+				state[d] = x;
+			}
+		}
+
+		/// <summary>
+		/// Writes the next point to out, which must hold Dimensions() values.
+		/// </summary>
+		/// <param name="out">Pointer to Dimensions() values.</param>
+		inline void Next(Float_t* out)
+		{
+			for (size_t d = 0; d < state.size(); d++) {
+				out[d] = Output(d);
+			}
+			Advance();
+		}
+
+		/// <summary>
+		/// Writes the next count points laid out as structure-of-arrays: coordinate d of point i is
+		/// written to out[d * count + i].
+		/// </summary>
+		/// <param name="out">Pointer to Dimensions() * count values.</param>
+		/// <param name="count">Number of points.</param>
+		inline void Fill(Float_t* out, size_t count)
+		{
+			for (size_t i = 0; i < count; i++) {
+				for (size_t d = 0; d < state.size(); d++) {
+					out[d * count + i] = Output(d);
+				}
+				Advance();
+			}
+		}
+	private:
+		struct Polynomial
+		{
+			std::uint8_t s;
+			std::uint8_t a;
+			std::uint16_t m[7];
+		};
+
+		std::vector<std::uint32_t> directions;
+		std::vector<std::uint32_t> state;
+		std::vector<std::uint32_t> seeds;
+		std::uint64_t index = 0;
+		bool scrambled = false;
+
+		inline static const Polynomial* Polynomials() noexcept
+		{
+			//Primitive polynomials and initial direction numbers for dimensions 2 to 37,
+			//from Joe and Kuo's new-joe-kuo-6.21201 table.
+			static constexpr Polynomial table[MaxDimensions - 1] = {
+				{ 1, 0, { 1, 0, 0, 0, 0, 0, 0 } },
+				{ 2, 1, { 1, 3, 0, 0, 0, 0, 0 } },
+				{ 3, 1, { 1, 3, 1, 0, 0, 0, 0 } },
+				{ 3, 2, { 1, 1, 1, 0, 0, 0, 0 } },
+				{ 4, 1, { 1, 1, 3, 3, 0, 0, 0 } },
+				{ 4, 4, { 1, 3, 5, 13, 0, 0, 0 } },
+				{ 5, 2, { 1, 1, 5, 5, 17, 0, 0 } },
+				{ 5, 4, { 1, 1, 5, 5, 5, 0, 0 } },
+				{ 5, 7, { 1, 1, 7, 11, 19, 0, 0 } },
+				{ 5, 11, { 1, 1, 5, 1, 1, 0, 0 } },
+				{ 5, 13, { 1, 1, 1, 3, 11, 0, 0 } },
+				{ 5, 14, { 1, 3, 5, 5, 31, 0, 0 } },
+				{ 6, 1, { 1, 3, 3, 9, 7, 49, 0 } },
+				{ 6, 13, { 1, 1, 1, 15, 21, 21, 0 } },
+				{ 6, 16, { 1, 3, 1, 13, 27, 49, 0 } },
+				{ 6, 19, { 1, 1, 1, 15, 7, 5, 0 } },
+				{ 6, 22, { 1, 3, 1, 15, 13, 25, 0 } },
+				{ 6, 25, { 1, 1, 5, 5, 19, 61, 0 } },
+				{ 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+				{ 7, 4, { 1, 3, 7, 13, 13, 15, 69 } },
+				{ 7, 7, { 1, 1, 3, 13, 7, 35, 63 } },
+				{ 7, 8, { 1, 3, 5, 9, 1, 25, 53 } },
+				{ 7, 14, { 1, 3, 1, 13, 9, 35, 107 } },
+				{ 7, 19, { 1, 3, 1, 5, 27, 61, 31 } },
+				{ 7, 21, { 1, 1, 5, 11, 19, 41, 61 } },
+				{ 7, 28, { 1, 3, 5, 3, 3, 13, 69 } },
+				{ 7, 31, { 1, 1, 7, 13, 1, 19, 1 } },
+				{ 7, 32, { 1, 3, 7, 5, 13, 19, 59 } },
+				{ 7, 37, { 1, 1, 3, 9, 25, 29, 41 } },
+				{ 7, 41, { 1, 3, 5, 13, 23, 1, 55 } },
+				{ 7, 42, { 1, 3, 7, 3, 13, 59, 17 } },
+				{ 7, 50, { 1, 3, 1, 3, 5, 53, 69 } },
+				{ 7, 55, { 1, 1, 5, 5, 23, 33, 13 } },
+				{ 7, 56, { 1, 1, 7, 7, 1, 61, 123 } },
+				{ 7, 59, { 1, 1, 7, 9, 13, 61, 49 } },
+				{ 7, 62, { 1, 3, 3, 5, 3, 55, 33 } },
+			};
+			return table;
+		}
+
+		inline static std::uint32_t ReverseBits(std::uint32_t x) noexcept
+		{
+			x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+			x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+			x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+			x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+			return (x >> 16) | (x << 16);
+		}
+
+		//Burley's hash-based nested uniform scramble. Each output bit only depends on the bits
+		//above it, which is what makes this an Owen scramble.
+		inline static std::uint32_t OwenScramble(std::uint32_t x, std::uint32_t seed) noexcept
+		{
+			x = ReverseBits(x);
+			x += seed;
+			x ^= x * 0x6c50b47cu;
+			x ^= x * 0xb82f1e52u;
+			x ^= x * 0xc7afe638u;
+			x ^= x * 0x8d22f6e6u;
+			return ReverseBits(x);
+		}
+
+		inline Float_t Output(size_t d) const noexcept
+		{
+			const std::uint32_t x = scrambled ? OwenScramble(state[d], seeds[d]) : state[d];
+			if constexpr (sizeof(Float_t) <= sizeof(float)) {
+				return static_cast<Float_t>(x >> 8) * static_cast<Float_t>(0x1p-24);
+			} else {
+				return static_cast<Float_t>(x) * static_cast<Float_t>(0x1p-32);
+			}
+		}
+
+		//Gray code order: each step flips the direction number of the lowest zero bit of the index.
+		inline void Advance() noexcept
+		{
+			std::uint64_t n = index++;
+			size_t bit = 0;
+			while (n & 1u) {
+				n >>= 1;
+				++bit;
+			}
+			bit &= 31;
+			for (size_t d = 0; d < state.size(); d++) {
+				state[d] ^= directions[d * 32 + bit];
+			}
+		}
+	};
+
+	/// <summary>
+	/// Halton low-discrepancy sequence using the first prime bases, with an optional random
+	/// Cranley-Patterson rotation seeded from the generator.
+	/// </summary>
+	/// <typeparam name="Float_t">Floating-point type of the coordinates.</typeparam>
+	template<typename Float_t = double>
+	class Halton
+	{
+	public:
+		/// <summary>
+		/// Creates a Halton sequence. Throws std::invalid_argument if dimensions is 0.
+		/// </summary>
+		/// <param name="dimensions">Number of dimensions of each point.</param>
+		/// <param name="scramble">Whether to randomly rotate the sequence using the global generator.</param>
+		explicit Halton(size_t dimensions, bool scramble = true RANDOM_CALL_SITE)
+			: bases(dimensions), shifts(dimensions, 0.0)
+		{
+			if (dimensions == 0) {
+				throw std::invalid_argument("Halton: unsupported number of dimensions");
+			}
+			std::uint32_t candidate = 2;
+			for (size_t d = 0; d < dimensions; candidate++) {
+				bool prime = true;
+				for (size_t i = 0; i < d && bases[i] * bases[i] <= candidate; i++) {
+					if (candidate % bases[i] == 0) {
+						prime = false;
+						break;
+					}
+				}
+				if (prime) {
+					bases[d++] = candidate;
+				}
+			}
+			if (scramble) {
+				RANDOM_PROFILE_CALL;
+				Rescramble(Use(Api::Samplers));
+			}
+		}
+
+		inline size_t Dimensions() const noexcept { return bases.size(); }
+		inline std::uint64_t Index() const noexcept { return index; }
+
+		/// <summary>
+		/// Draws a new rotation from the supplied engine. The sequence position is kept.
+		/// </summary>
+		/// <param name="engine">Engine to draw from.</param>
+		template<typename Engine_t>
+		inline void Rescramble(Engine_t& engine)
+		{
+			for (auto& shift : shifts) {
+				shift = UnitFloat<double>(engine);
+			}
+		}
+
+		/// <summary>
+		/// Draws a new rotation from the global generator. The sequence position is kept.
+		/// </summary>
+		inline void Rescramble(RANDOM_CALL_SITE_ONLY)
+		{
+			RANDOM_PROFILE_CALL;
+			Rescramble(Use(Api::Samplers));
+		}
+
+		/// <summary>
+		/// Moves the sequence to point number index.
+		/// </summary>
+		/// <param name="index">Index of the next point to generate.</param>
+		inline void Seek(std::uint64_t index) noexcept
+		{
+			this->index = index;
+		}
+
+		/// <summary>
+		/// Writes the next point to out, which must hold Dimensions() values.
+		/// </summary>
+		/// <param name="out">Pointer to Dimensions() values.</param>
+		inline void Next(Float_t* out)
+		{
+			for (size_t d = 0; d < bases.size(); d++) {
+				out[d] = Output(d, index);
+			}
+			++index;
+		}
+
+		/// <summary>
+		/// Writes the next count points laid out as structure-of-arrays: coordinate d of point i is
+		/// written to out[d * count + i].
+		/// </summary>
+		/// <param name="out">Pointer to Dimensions() * count values.</param>
+		/// <param name="count">Number of points.</param>
+		inline void Fill(Float_t* out, size_t count)
+		{
+			for (size_t d = 0; d < bases.size(); d++) {
+				for (size_t i = 0; i < count; i++) {
+					out[d * count + i] = Output(d, index + i);
+				}
+			}
+			index += count;
+		}
+	private:
+		std::vector<std::uint32_t> bases;
+		std::vector<double> shifts;
+		std::uint64_t index = 0;
+
+		inline Float_t Output(size_t d, std::uint64_t n) const noexcept
+		{
+			const std::uint32_t base = bases[d];
+			const double invBase = 1.0 / base;
+			double factor = invBase, x = shifts[d];
+			for (; n != 0; n /= base) {
+				x += static_cast<double>(n % base) * factor;
+				factor *= invBase;
+			}
+			x -= std::floor(x);
+			//x is below 1, but a float can round it up to 1. 1 - epsilon / 2 is the largest value below 1.
+			constexpr Float_t belowOne = Float_t(1) - std::numeric_limits<Float_t>::epsilon() / 2;
+			return std::min(static_cast<Float_t>(x), belowOne);
+		}
+	};
+
+	/// <summary>
+	/// Roberts' additive R-sequence, the d-dimensional generalization of the golden ratio sequence
+	/// (R2 in two dimensions). Computed in 64-bit fixed point, so it does not drift over long runs.
+	/// The starting offset is drawn from the generator.
+	/// </summary>
+	/// <typeparam name="Float_t">Floating-point type of the coordinates.</typeparam>
+	template<typename Float_t = double>
+	class RSequence
+	{
+	public:
+		/// <summary>
+		/// Creates an R-sequence. Throws std::invalid_argument if dimensions is 0.
+		/// </summary>
+		/// <param name="dimensions">Number of dimensions of each point.</param>
+		/// <param name="scramble">Whether to randomly offset the sequence using the global generator.</param>
+		explicit RSequence(size_t dimensions, bool scramble = true RANDOM_CALL_SITE)
+			: alphas(dimensions), offsets(dimensions, 0x8000000000000000ull)
+		{
+			if (dimensions == 0) {
+				throw std::invalid_argument("RSequence: unsupported number of dimensions");
+			}
+			//phi is the unique positive root of x^(d+1) = x + 1.
+			double phi = 2.0;
+			for (int i = 0; i < 64; i++) {
+				phi = std::pow(1.0 + phi, 1.0 / static_cast<double>(dimensions + 1));
+			}
+			double alpha = 1.0;
+			for (size_t d = 0; d < dimensions; d++) {
+				alpha /= phi;
+				alphas[d] = static_cast<std::uint64_t>(std::ldexp(alpha - std::floor(alpha), 64));
+			}
+			if (scramble) {
+				RANDOM_PROFILE_CALL;
+				Rescramble(Use(Api::Samplers));
+			}
+		}
+
+		inline size_t Dimensions() const noexcept { return alphas.size(); }
+		inline std::uint64_t Index() const noexcept { return index; }
+
+		/// <summary>
+		/// Draws a new offset from the supplied engine. The sequence position is kept.
+		/// </summary>
+		/// <param name="engine">Engine to draw from.</param>
+		template<typename Engine_t>
+		inline void Rescramble(Engine_t& engine)
+		{
+			for (auto& offset : offsets) {
+				offset = Bits64(engine);
+			}
+		}
+
+		/// <summary>
+		/// Draws a new offset from the global generator. The sequence position is kept.
+		/// </summary>
+		inline void Rescramble(RANDOM_CALL_SITE_ONLY)
+		{
+			RANDOM_PROFILE_CALL;
+			Rescramble(Use(Api::Samplers));
+		}
+
+		/// <summary>
+		/// Moves the sequence to point number index.
+		/// </summary>
+		/// <param name="index">Index of the next point to generate.</param>
+		inline void Seek(std::uint64_t index) noexcept
+		{
+			this->index = index;
+		}
+
+		/// <summary>
+		/// Writes the next point to out, which must hold Dimensions() values.
+		/// </summary>
+		/// <param name="out">Pointer to Dimensions() values.</param>
+		inline void Next(Float_t* out)
+		{
+			for (size_t d = 0; d < alphas.size(); d++) {
+				out[d] = ToFloat(offsets[d] + index * alphas[d]);
+			}
+			++index;
+		}
+
+		/// <summary>
+		/// Writes the next count points laid out as structure-of-arrays: coordinate d of point i is
+		/// written to out[d * count + i].
+		/// </summary>
+		/// <param name="out">Pointer to Dimensions() * count values.</param>
+		/// <param name="count">Number of points.</param>
+		inline void Fill(Float_t* out, size_t count)
+		{
+			for (size_t d = 0; d < alphas.size(); d++) {
+				const std::uint64_t alpha = alphas[d];
+				const std::uint64_t start = offsets[d] + index * alpha;
+				Float_t* o = out + d * count;
+				for (size_t i = 0; i < count; i++) {
+					o[i] = ToFloat(start + static_cast<std::uint64_t>(i) * alpha);
+				}
+			}
+			index += count;
+		}
+	private:
+		std::vector<std::uint64_t> alphas;
+		std::vector<std::uint64_t> offsets;
+		std::uint64_t index = 0;
+
+		inline static Float_t ToFloat(std::uint64_t x) noexcept
+		{
+			if constexpr (sizeof(Float_t) <= sizeof(float)) {
+				return static_cast<Float_t>(x >> 40) * static_cast<Float_t>(0x1p-24);
+			} else {
+				return static_cast<Float_t>(x >> 11) * static_cast<Float_t>(0x1p-53);
+			}
+		}
+	};
+
+	/// <summary>
+	/// Counter-based Philox4x32-10 engine. Value i of stream k under a given key is a pure function
+	/// of (key, k, i), so any element can be computed directly with At, and parallel loops can
+	/// give every iteration its own engine without sharing state or depending on the work split.
+	/// Satisfies UniformRandomBitGenerator, so it works with the samplers and std distributions.
+	/// </summary>
+	class Philox
+	{
+	public:
+		using result_type = std::uint32_t;
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+		/// <summary>
+		/// Creates an engine positioned at the start of a stream.
+		/// </summary>
+		/// <param name="key">Key (seed) shared by all streams.</param>
+		/// <param name="stream">Stream number.</param>
+		/// <param name="position">Index of the first value to generate.</param>
+		explicit Philox(std::uint64_t key = 0, std::uint64_t stream = 0, std::uint64_t position = 0) noexcept
+			: key(key), stream(stream), position(position)
+		{
+			if (position & 3u) {
+				Block(key, stream, position >> 2, buffer);
+			}
+		}
+
+		inline void seed(std::uint64_t key, std::uint64_t stream = 0) noexcept
+		{
+			*this = Philox(key, stream);
+		}
+
+		inline result_type operator()() noexcept
+		{
+			if ((position & 3u) == 0) {
+				Block(key, stream, position >> 2, buffer);
+			}
+			return buffer[position++ & 3u];
+		}
+
+		/// <summary>
+		/// Moves the engine to value number index in O(1).
+		/// </summary>
+		/// <param name="index">Index of the next value to generate.</param>
+		inline void Seek(std::uint64_t index) noexcept
+		{
+			*this = Philox(key, stream, index);
+		}
+
+		inline void discard(std::uint64_t n) noexcept
+		{
+			Seek(position + n);
+		}
+
+		inline std::uint64_t Key() const noexcept { return key; }
+		inline std::uint64_t Stream() const noexcept { return stream; }
+		inline std::uint64_t Position() const noexcept { return position; }
+
+		/// <summary>
+		/// Returns value number index of a stream without any engine state.
+		/// </summary>
+		/// <param name="key">Key (seed) shared by all streams.</param>
+		/// <param name="stream">Stream number.</param>
+		/// <param name="index">Index of the value within the stream.</param>
+		/// <returns></returns>
+		inline static result_type At(std::uint64_t key, std::uint64_t stream, std::uint64_t index) noexcept
+		{
+			std::uint32_t out[4];
+			Block(key, stream, index >> 2, out);
+			return out[index & 3u];
+		}
+
+		/// <summary>
+		/// Writes count consecutive values of a stream, starting at value number first.
+		/// Whole blocks are computed independently of each other, so the loop vectorizes.
+		/// </summary>
+		/// <param name="key">Key (seed) shared by all streams.</param>
+		/// <param name="stream">Stream number.</param>
+		/// <param name="first">Index of the first value.</param>
+		/// <param name="out">Pointer to count values.</param>
+		/// <param name="count">Number of values.</param>
+		static void Fill(std::uint64_t key, std::uint64_t stream, std::uint64_t first, std::uint32_t* out, size_t count) noexcept
+		{
+			while (count != 0 && (first & 3u) != 0) {
+				*out++ = At(key, stream, first++);
+				--count;
+			}
+			const size_t blocks = count / 4;
+			for (size_t b = 0; b < blocks; b++) {
+				Block(key, stream, (first >> 2) + b, out + 4 * b);
+			}
+			first += 4 * blocks;
+			out += 4 * blocks;
+			for (size_t i = 0; i < count % 4; i++) {
+				out[i] = At(key, stream, first + i);
+			}
+		}
+
+		/// <summary>
+		/// Computes one 128-bit Philox block: the four values starting at index 4 * block.
+		/// </summary>
+		static void Block(std::uint64_t key, std::uint64_t stream, std::uint64_t block, std::uint32_t out[4]) noexcept
+		{
+			std::uint32_t c0 = static_cast<std::uint32_t>(block), c1 = static_cast<std::uint32_t>(block >> 32);
+			std::uint32_t c2 = static_cast<std::uint32_t>(stream), c3 = static_cast<std::uint32_t>(stream >> 32);
+			std::uint32_t k0 = static_cast<std::uint32_t>(key), k1 = static_cast<std::uint32_t>(key >> 32);
+			for (int round = 0; round < 10; round++) {
+				const std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * c0;
+				const std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c2;
+				const std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+				const std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+				c0 = n0;
+				c1 = static_cast<std::uint32_t>(p1);
+				c2 = n2;
+				c3 = static_cast<std::uint32_t>(p0);
+				k0 += 0x9E3779B9u;
+				k1 += 0xBB67AE85u;
+			}
+			out[0] = c0;
+			out[1] = c1;
+			out[2] = c2;
+			out[3] = c3;
+		}
+
+		friend inline bool operator==(const Philox& a, const Philox& b) noexcept
+		{
+			return a.key == b.key && a.stream == b.stream && a.position == b.position;
+		}
+
+		friend inline bool operator!=(const Philox& a, const Philox& b) noexcept
+		{
+			return !(a == b);
+		}
+	private:
+		std::uint64_t key;
+		std::uint64_t stream;
+		std::uint64_t position;
+		std::uint32_t buffer[4] = {};
+	};
+
+	/// <summary>
+	/// Generator handle that owns its engine and exposes the Random API as member functions.
+	/// Streams are small values meant to be stored per object (e.g. one per agent in an array),
+	/// so each object gets its own reproducible sequence without touching the global generator.
+	/// </summary>
+	/// <typeparam name="Engine_t">Engine type. Any pcg engine or UniformRandomBitGenerator works.</typeparam>
+	template<typename Engine_t>
+	class BasicStream
+	{
+	public:
+		using engine_type = Engine_t;
+		using result_type = typename Engine_t::result_type;
+
+		static constexpr result_type min() { return Engine_t::min(); }
+		static constexpr result_type max() { return Engine_t::max(); }
+
+		/// <summary>
+		/// Creates a stream for object id under a global seed. Different ids give unrelated sequences.
+		/// pcg engines are seeded with Hash(seed, id) as their state, engines that take a seed sequence
+		/// (like std::mt19937) get one made from the hash, and any other engine is constructed from the hash.
+		/// </summary>
+		/// <param name="seed">Global seed.</param>
+		/// <param name="id">Object id.</param>
+		explicit BasicStream(std::uint64_t seed = 0, std::uint64_t id = 0)
+			: engine(MakeEngine(Hash_Impl(seed, id, 0, 0)))
+		{
+		}
+
+		explicit BasicStream(const Engine_t& engine) : engine(engine)
+		{
+		}
+
+		/// <summary>
+		/// Draws raw bits from the engine, so a stream can be passed anywhere an engine is expected.
+		/// </summary>
+		/// <returns></returns>
+		inline result_type operator()() { return engine(); }
+
+		inline Engine_t& Engine() noexcept { return engine; }
+		inline const Engine_t& Engine() const noexcept { return engine; }
+
+		/// <summary>
+		/// Generates a random integer of chosen size between begin and end (inclusive).
+		/// Uses a uniform distribution.
+		/// </summary>
+		/// <param name="begin"></param>
+		/// <param name="end"></param>
+		/// <returns></returns>
+		template<class Int_t>
+		inline Int_t GetInt(Int_t begin, Int_t end)
+		{
+			return GetInt_Impl(engine, begin, end);
+		}
+
+		/// <summary>
+		/// Generates a random integer between 0 and t (inclusive).
+		/// Uses a binomial distribution with a probability of p.
+		/// </summary>
+		/// <param name="t"></param>
+		/// <param name="p"></param>
+		/// <returns></returns>
+		template<class Int_t>
+		inline Int_t GetIntBinomial(Int_t t, double p)
+		{
+			return GetInt_Binomial_Impl(engine, t, p);
+		}
+
+		/// <summary>
+		/// Generates a random unsigned 8-bit integer between 0 and 255 (inclusive).
+		/// </summary>
+		/// <returns></returns>
+		inline unsigned char GetByte()
+		{
+			return GetByte_Impl(engine);
+		}
+
+		/// <summary>
+		/// Fills size bytes at data with random bytes, see Random::FillBytes.
+		/// </summary>
+		/// <param name="data">Destination.</param>
+		/// <param name="size">Number of bytes.</param>
+		inline void FillBytes(void* data, size_t size)
+		{
+			FillBytes_Impl(engine, data, size);
+		}
+
+		/// <summary>
+		/// Generates a random float between min and max (exclusive).
+		/// Uses a uniform distribution.
+		/// </summary>
+		/// <param name="min"></param>
+		/// <param name="max"></param>
+		/// <returns></returns>
+		template<typename Float_t>
+		inline Float_t GetFloat(Float_t min, Float_t max)
+		{
+			return GetFloat_Impl(engine, min, max);
+		}
+
+		/// <summary>
+		/// Generates a random float with a normal distribution.
+		/// </summary>
+		/// <param name="mean"></param>
+		/// <param name="stddev"></param>
+		/// <returns></returns>
+		template<typename Float_t>
+		inline Float_t GetFloatNormal(Float_t mean, Float_t stddev = static_cast<Float_t>(1.0))
+		{
+			return GetFloat_Normal_Impl(engine, mean, stddev);
+		}
+
+		/// <summary>
+		/// Returns true with probability pct.
+		/// </summary>
+		/// <param name="pct">The percentage chance that the function returns true.</param>
+		/// <returns></returns>
+		inline bool Chance(double pct)
+		{
+			pct = std::clamp(pct, 0.0, 1.0);
+			return GetFloat_Impl(engine, 0.0, 1.0) < pct;
+		}
+
+		/// <summary>
+		/// Returns true with probability n / d.
+		/// </summary>
+		/// <param name="n">Numerator of the fraction.</param>
+		/// <param name="d">Denominator of the fraction.</param>
+		/// <returns></returns>
+		inline bool Chance(int n, int d)
+		{
+			n = std::clamp(n, 0, d);
+			return GetInt_Impl(engine, 1, d) <= n;
+		}
+
+		/// <summary>
+		/// Shuffles a container between iterators begin and end.
+		/// </summary>
+		/// <param name="begin">Start iterator.</param>
+		/// <param name="end">End iterator.</param>
+		template<typename Iter_t>
+		inline void Shuffle(Iter_t begin, Iter_t end)
+		{
+			std::shuffle(begin, end, engine);
+		}
+
+		/// <summary>
+		/// Shuffles a container.
+		/// </summary>
+		/// <param name="container">Reference to container to be shuffled.</param>
+		template<typename Container_t>
+		inline void Shuffle(Container_t& container)
+		{
+			std::shuffle(container.begin(), container.end(), engine);
+		}
+
+		/// <summary>
+		/// Copies a container, then shuffles and returns the copy.
+		/// </summary>
+		/// <param name="container">Constant reference to container to be copied and shuffled.</param>
+		template<typename Container_t>
+		inline Container_t ShuffleCopy(const Container_t& container)
+		{
+			Container_t copy = container;
+			std::shuffle(copy.begin(), copy.end(), engine);
+			return copy;
+		}
+
+		/// <summary>
+		/// Writes a shuffled copy of [first, last) to out in one pass, without modifying the source.
+		/// out must be a random access iterator with room for every element, not an output iterator.
+		/// </summary>
+		/// <param name="first">Start of the source range.</param>
+		/// <param name="last">End of the source range.</param>
+		/// <param name="out">Start of the random access destination range.</param>
+		/// <returns>Iterator past the last element written.</returns>
+		template<typename InIter_t, typename RandomIter_t>
+		inline RandomIter_t ShuffleInto(InIter_t first, InIter_t last, RandomIter_t out)
+		{
+			return ShuffleInto_Impl(engine, first, last, out);
+		}
+
+#ifdef RANDOM_HAS_POSIX
+		/// <summary>
+		/// Shuffles a file of fixed-size records in place, see Random::ShuffleFile.
+		/// </summary>
+		/// <param name="path">File to shuffle.</param>
+		/// <param name="recordSize">Size of each record in bytes.</param>
+		/// <param name="memoryBudget">Approximate memory to use, in bytes.</param>
+		inline void ShuffleFile(const std::string& path, size_t recordSize, size_t memoryBudget = RANDOM_FILE_MEMORY_BUDGET)
+		{
+			ShuffleFile_Impl(engine, path, path, recordSize, memoryBudget);
+		}
+
+		/// <summary>
+		/// Writes the records of inPath to outPath in random order, see Random::ShuffleFile.
+		/// </summary>
+		/// <param name="inPath">File to read.</param>
+		/// <param name="outPath">File to create or overwrite.</param>
+		/// <param name="recordSize">Size of each record in bytes.</param>
+		/// <param name="memoryBudget">Approximate memory to use, in bytes.</param>
+		inline void ShuffleFile(const std::string& inPath, const std::string& outPath, size_t recordSize,
+			size_t memoryBudget = RANDOM_FILE_MEMORY_BUDGET)
+		{
+			ShuffleFile_Impl(engine, inPath, outPath, recordSize, memoryBudget);
+		}
+
+		/// <summary>
+		/// Picks k distinct records from a file of fixed-size records, see Random::SampleFile.
+		/// </summary>
+		/// <param name="path">File to sample.</param>
+		/// <param name="recordSize">Size of each record in bytes.</param>
+		/// <param name="k">Number of records.</param>
+		/// <returns>k * recordSize bytes.</returns>
+		inline std::vector<unsigned char> SampleFile(const std::string& path, size_t recordSize, size_t k)
+		{
+			return SampleFile_Impl(engine, path, recordSize, k);
+		}
+
+		/// <summary>
+		/// Writes size random bytes to a file descriptor, see Random::WriteBytes.
+		/// </summary>
+		/// <param name="fd">File descriptor to write to.</param>
+		/// <param name="size">Number of bytes.</param>
+		/// <param name="bufferSize">Size of the write buffer in bytes.</param>
+		inline void WriteBytes(int fd, std::uint64_t size, size_t bufferSize = RANDOM_WRITE_BUFFER_SIZE)
+		{
+			WriteBytes_Impl(engine, fd, size, bufferSize);
+		}
+#endif
+
+		/// <summary>
+		/// Generates a string of length "length" + 1 with characters between begin and end (inclusive).
+		/// </summary>
+		/// <param name="begin"></param>
+		/// <param name="end"></param>
+		/// <param name="length"></param>
+		/// <returns></returns>
+		inline std::string GetString(char begin, char end, const size_t length)
+		{
+			return GetString_Impl(engine, begin, end, length);
+		}
+
+		/// <summary>
+		/// Generates a string of length "length" + 1 with a defined charset.
+		/// </summary>
+		/// <param name="charset"></param>
+		/// <param name="length"></param>
+		/// <returns></returns>
+		inline std::string GetString(std::string_view charset, const size_t length)
+		{
+			return GetString_Impl(engine, charset, length);
+		}
+
+		/// <summary>
+		/// Generates N random integers between begin and end and returns them in a std::array.
+		/// </summary>
+		/// <param name="begin"></param>
+		/// <param name="end"></param>
+		/// <returns></returns>
+		template<size_t N, typename Int_t>
+		inline std::array<Int_t, N> GetIntArray(Int_t begin, Int_t end)
+		{
+			return GetIntArray_Impl<Int_t, N>(engine, begin, end);
+		}
+
+		/// <summary>
+		/// Generates N random floats between begin and end and returns them in a std::array.
+		/// </summary>
+		/// <param name="begin"></param>
+		/// <param name="end"></param>
+		/// <returns></returns>
+		template<size_t N, typename Float_t>
+		inline std::array<Float_t, N> GetFloatArray(Float_t begin, Float_t end)
+		{
+			return GetFloatArray_Impl<Float_t, N>(engine, begin, end);
+		}
+
+		/// <summary>
+		/// Generates count random integers between begin and end (inclusive) into a std::vector
+		/// allocated with alloc.
+		/// </summary>
+		/// <param name="count">Number of values.</param>
+		/// <param name="begin"></param>
+		/// <param name="end"></param>
+		/// <param name="alloc">Allocator for the vector.</param>
+		/// <returns></returns>
+		template<typename Int_t, typename Alloc_t = std::allocator<Int_t>, typename = std::enable_if_t<!std::is_pointer_v<Alloc_t>>>
+		inline std::vector<Int_t, Alloc_t> GetIntVector(size_t count, Int_t begin, Int_t end, const Alloc_t& alloc = Alloc_t())
+		{
+			return GetIntVector_Impl<Int_t>(engine, count, begin, end, alloc);
+		}
+
+		/// <summary>
+		/// Generates count random floats between min and max (exclusive) into a std::vector
+		/// allocated with alloc.
+		/// </summary>
+		/// <param name="count">Number of values.</param>
+		/// <param name="min"></param>
+		/// <param name="max"></param>
+		/// <param name="alloc">Allocator for the vector.</param>
+		/// <returns></returns>
+		template<typename Float_t, typename Alloc_t = std::allocator<Float_t>, typename = std::enable_if_t<!std::is_pointer_v<Alloc_t>>>
+		inline std::vector<Float_t, Alloc_t> GetFloatVector(size_t count, Float_t min, Float_t max, const Alloc_t& alloc = Alloc_t())
+		{
+			return GetFloatVector_Impl<Float_t>(engine, count, min, max, alloc);
+		}
+
+#ifdef RANDOM_HAS_PMR
+		template<typename Int_t>
+		inline std::pmr::vector<Int_t> GetIntVector(size_t count, Int_t begin, Int_t end, std::pmr::memory_resource* resource)
+		{
+			return GetIntVector_Impl<Int_t>(engine, count, begin, end, std::pmr::polymorphic_allocator<Int_t>(resource));
+		}
+
+		template<typename Float_t>
+		inline std::pmr::vector<Float_t> GetFloatVector(size_t count, Float_t min, Float_t max, std::pmr::memory_resource* resource)
+		{
+			return GetFloatVector_Impl<Float_t>(engine, count, min, max, std::pmr::polymorphic_allocator<Float_t>(resource));
+		}
+#endif
+
+		/// <summary>
+		/// Reseeds the engine. The arguments are passed on to the engine's seed function.
+		/// </summary>
+		template<typename... Args>
+		inline void Seed(Args&& ...args)
+		{
+			engine.seed(args...);
+		}
+
+		friend inline bool operator==(const BasicStream& a, const BasicStream& b)
+		{
+			return a.engine == b.engine;
+		}
+
+		friend inline bool operator!=(const BasicStream& a, const BasicStream& b)
+		{
+			return !(a == b);
+		}
+	private:
+		template<typename E, typename = void>
+		struct HasStateType : std::false_type {};
+
+		template<typename E>
+		struct HasStateType<E, std::void_t<typename E::state_type>> : std::true_type {};
+
+		inline static Engine_t MakeEngine(std::uint64_t hash)
+		{
+			if constexpr (HasStateType<Engine_t>::value) {
+				return Engine_t(static_cast<typename Engine_t::state_type>(hash));
+			}
+			else if constexpr (std::is_constructible_v<Engine_t, std::seed_seq&>) {
+				std::seed_seq seq{ static_cast<std::uint32_t>(hash), static_cast<std::uint32_t>(hash >> 32) };
+				return Engine_t(seq);
+			}
+			else {
+				return Engine_t(hash);
+			}
+		}
+
+		Engine_t engine;
+	};
+
+	/// <summary>
+	/// Stream backed by an 8-byte single-sequence pcg engine (64-bit state, 32-bit output).
+	/// </summary>
+	using Stream = BasicStream<pcg32_oneseq>;
+
+	/// <summary>
+	/// Stream backed by a 4-byte single-sequence pcg engine (32-bit state, 16-bit output).
+	/// All CompactStreams walk the same cycle of 2^32 outputs and only differ in where they start,
+	/// so their sequences overlap once an object draws past the next object's start. With N objects the
+	/// starts are on average 2^32 / N draws apart: about 4,300 draws for a million objects and 430 for
+	/// ten million. The closest pair is expected only about 2^32 / N^2 apart, so with a million objects
+	/// some of them share values almost immediately. Use it for a few draws per object where such
+	/// overlaps don't matter, and use Stream otherwise.
+	/// </summary>
+	using CompactStream = BasicStream<pcg_engines::oneseq_xsh_rr_32_16>;
+
+	/// <summary>
+	/// Background thread that pre-generates random values into lock-free single-producer,
+	/// single-consumer ring buffers, one per consumer thread. Consumers pop ready values
+	/// without running the engine, and fall back to generating inline when their queue is empty.
+	/// The producer only fills free slots and sleeps until a consumer frees one.
+	/// </summary>
+	class AsyncProducer
+	{
+		class QueueBase
+		{
+		public:
+			virtual ~QueueBase() = default;
+			virtual size_t Refill(size_t maxCount) = 0;
+			virtual bool Full() const noexcept = 0;
+		};
+
+		//Shared by the producer and its queues, so a queue that outlives its producer can still signal it.
+		struct Signal
+		{
+			std::mutex mutex;
+			std::condition_variable wake;
+			std::atomic<bool> idle{ false };
+			bool changed = false;
+			bool stopping = false;
+
+			void Notify()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					changed = true;
+				}
+				wake.notify_one();
+			}
+		};
+	public:
+		/// <summary>
+		/// Consumer handle for one queue. Must only be popped from one thread at a time.
+		/// </summary>
+		/// <typeparam name="Sampler_t">Callable taking a Stream_t& and returning a value.</typeparam>
+		/// <typeparam name="Stream_t">Stream type the values are drawn from, constructed from (seed, id).</typeparam>
+		template<typename Sampler_t, typename Stream_t = Stream>
+		class Queue : public QueueBase
+		{
+		public:
+			using value_type = std::decay_t<decltype(std::declval<const Sampler_t&>()(std::declval<Stream_t&>()))>;
+
+			Queue(const Sampler_t& sampler, size_t capacity, std::uint64_t seed, std::uint64_t id, std::shared_ptr<Signal> signal)
+				: signal(std::move(signal)), producerSampler(sampler), fallbackSampler(sampler),
+				producerStream(seed, 2 * id), fallbackStream(seed, 2 * id + 1)
+			{
+				size_t size = 1;
+				while (size < capacity) {
+					size <<= 1;
+				}
+				buffer.resize(size);
+				mask = size - 1;
+				wakeMask = size / 2 - (size > 1 ? 1 : 0);
+			}
+
+			/// <summary>
+			/// Pops a pre-generated value if one is ready. Values come out in the order the producer's
+			/// stream generated them.
+			/// </summary>
+			/// <param name="out">Receives the value.</param>
+			/// <returns>False if the queue was empty.</returns>
+			inline bool TryPop(value_type& out)
+			{
+				const size_t h = head.load(std::memory_order_relaxed);
+				if (h == readyTail) {
+					readyTail = tail.load(std::memory_order_acquire);
+					if (h == readyTail) {
+						return false;
+					}
+				}
+				out = buffer[h & mask];
+				head.store(h + 1, std::memory_order_release);
+				if (RANDOM_UNLIKELY(((h + 1) & wakeMask) == 0)) {
+					WakeProducer();
+				}
+				return true;
+			}
+
+			/// <summary>
+			/// Returns a pre-generated value, or generates one inline if the queue is empty.
+			/// </summary>
+			/// <returns></returns>
+			inline value_type Pop()
+			{
+				value_type value;
+				if (!TryPop(value)) {
+					++misses;
+					value = fallbackSampler(fallbackStream);
+				}
+				return value;
+			}
+
+			/// <summary>
+			/// Writes count values to out, taking as many as are ready and generating the rest inline.
+			/// </summary>
+			/// <param name="out">Pointer to count values.</param>
+			/// <param name="count">Number of values.</param>
+			void Pop(value_type* out, size_t count)
+			{
+				const size_t h = head.load(std::memory_order_relaxed);
+				readyTail = tail.load(std::memory_order_acquire);
+				const size_t ready = std::min(count, readyTail - h);
+				for (size_t i = 0; i < ready; i++) {
+					out[i] = buffer[(h + i) & mask];
+				}
+				head.store(h + ready, std::memory_order_release);
+				WakeProducer();
+				misses += count - ready;
+				for (size_t i = ready; i < count; i++) {
+					out[i] = fallbackSampler(fallbackStream);
+				}
+			}
+
+			inline size_t Capacity() const noexcept { return buffer.size(); }
+
+			/// <summary>
+			/// Number of values that had to be generated inline because the queue was empty.
+			/// </summary>
+			inline std::uint64_t Misses() const noexcept { return misses; }
+		private:
+			alignas(64) std::atomic<size_t> head{ 0 };
+			//the consumer's last look at tail, so it only reads the producer's cache line once per batch
+			size_t readyTail = 0;
+			alignas(64) std::atomic<size_t> tail{ 0 };
+			alignas(64) std::vector<value_type> buffer;
+			size_t mask;
+			size_t wakeMask;
+			std::shared_ptr<Signal> signal;
+			Sampler_t producerSampler, fallbackSampler;
+			Stream_t producerStream, fallbackStream;
+			std::uint64_t misses = 0;
+
+			//Called every half capacity of pops. The producer only sleeps once
+			//every queue was full and sets idle before its last look at them, so with the fence either that
+			//look sees this pop or this load sees idle. Waking it every half capacity rather than on every pop
+			//keeps the producer asleep long enough to be worth the wakeup, while the queue still holds the other
+			//half. The exchange lets a single consumer do the wakeup.
+			RANDOM_NOINLINE void WakeProducer()
+			{
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (signal->idle.load(std::memory_order_relaxed) && signal->idle.exchange(false)) {
+					signal->Notify();
+				}
+			}
+
+			size_t Refill(size_t maxCount) override
+			{
+				const size_t t = tail.load(std::memory_order_relaxed);
+				const size_t free = buffer.size() - (t - head.load(std::memory_order_acquire));
+				const size_t n = std::min(free, maxCount);
+				for (size_t i = 0; i < n; i++) {
+					buffer[(t + i) & mask] = producerSampler(producerStream);
+				}
+				tail.store(t + n, std::memory_order_release);
+				return n;
+			}
+
+			bool Full() const noexcept override
+			{
+				return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_seq_cst) == buffer.size();
+			}
+		};
+
+		/// <summary>
+		/// Starts the producer thread. With a single hardware thread the producer could only run in time
+		/// taken from the consumers, so by default it isn't started and Pop generates every value inline.
+		/// </summary>
+		/// <param name="background">Whether to start the producer thread.</param>
+		explicit AsyncProducer(bool background = std::thread::hardware_concurrency() != 1 RANDOM_CALL_SITE)
+			: signal(std::make_shared<Signal>())
+		{
+			if (background) {
+				worker = std::thread([this] { Run(); });
+			}
+			//Queues only read the seed in MakeQueue, which cannot run before the constructor returns.
+			RANDOM_PROFILE_CALL;
+			seed = Bits64(Use(Api::Samplers));
+		}
+
+		AsyncProducer(const AsyncProducer&) = delete;
+		AsyncProducer& operator=(const AsyncProducer&) = delete;
+
+		/// <summary>
+		/// Stops the producer thread. Queues that are still held keep their ready values and then
+		/// generate inline.
+		/// </summary>
+		~AsyncProducer()
+		{
+			{
+				std::lock_guard<std::mutex> lock(signal->mutex);
+				signal->stopping = true;
+				signal->changed = true;
+			}
+			signal->wake.notify_one();
+			if (worker.joinable()) {
+				worker.join();
+			}
+		}
+
+		/// <summary>
+		/// Creates a queue filled by this producer. Each consumer thread should have its own queue.
+		/// The producer stops filling a queue once every other owner has released it.
+		/// </summary>
+		/// <typeparam name="Stream_t">Stream type passed to the sampler, Random::Stream by default.</typeparam>
+		/// <param name="sampler">Callable taking a Stream_t& and returning a value, e.g. Random::Normal&lt;double&gt;().</param>
+		/// <param name="capacity">Number of values to keep ready. Rounded up to a power of two.</param>
+		/// <returns></returns>
+		template<typename Stream_t = Stream, typename Sampler_t>
+		std::shared_ptr<Queue<Sampler_t, Stream_t>> MakeQueue(const Sampler_t& sampler, size_t capacity = 4096)
+		{
+			std::lock_guard<std::mutex> lock(signal->mutex);
+			auto queue = std::make_shared<Queue<Sampler_t, Stream_t>>(sampler, capacity, seed, nextId++, signal);
+			queues.push_back(queue);
+			signal->changed = true;
+			signal->wake.notify_one();
+			return queue;
+		}
+	private:
+		static constexpr size_t RefillBatch = 256;
+
+		std::shared_ptr<Signal> signal;
+		std::uint64_t seed = 0;
+		std::uint64_t nextId = 0;
+		std::vector<std::shared_ptr<QueueBase>> queues;
+		std::thread worker;
+
+		//The lock is only held to take a snapshot of the queues, so MakeQueue never waits for a refill.
+		void Run()
+		{
+			std::vector<std::shared_ptr<QueueBase>> snapshot;
+			for (;;) {
+				{
+					std::lock_guard<std::mutex> lock(signal->mutex);
+					if (signal->stopping) {
+						return;
+					}
+					//a queue that only the producer still holds has no consumers left
+					queues.erase(std::remove_if(queues.begin(), queues.end(),
+						[](const std::shared_ptr<QueueBase>& queue) { return queue.use_count() == 1; }), queues.end());
+					snapshot = queues;
+					signal->changed = false;
+				}
+				size_t produced = 0;
+				for (const auto& queue : snapshot) {
+					produced += queue->Refill(RefillBatch);
+				}
+				if (produced == 0) {
+					//Announce the sleep before the last look at the queues. A pop that this look missed comes
+					//after the store, so it sees idle and wakes the producer. Without a timeout, the producer
+					//only wakes for a pop, a new queue or shutdown.
+					signal->idle.store(true);
+					const bool full = std::all_of(snapshot.begin(), snapshot.end(),
+						[](const std::shared_ptr<QueueBase>& queue) { return queue->Full(); });
+					if (full) {
+						std::unique_lock<std::mutex> lock(signal->mutex);
+						signal->wake.wait(lock, [this] { return signal->stopping || signal->changed; });
+					}
+					signal->idle.store(false, std::memory_order_relaxed);
+				}
+				snapshot.clear();
+			}
+		}
+	};
+
+	/// <summary>
+	/// Lazy, unbounded range of random values drawn from a distribution that is set up once.
+	/// Iterating it runs the distribution directly in the loop instead of filling a container first.
+	/// Use Take(n) to bound it. When compiled as C++20 it is also a std::ranges::view, so it works
+	/// with std::views adaptors such as std::views::take.
+	/// </summary>
+	/// <typeparam name="Dist_t">Distribution or sampler, called as dist(engine).</typeparam>
+	/// <typeparam name="Engine_t">Engine type.</typeparam>
+	template<typename Dist_t, typename Engine_t = Engine>
+	class Sequence
+#if defined(__cpp_lib_ranges)
+		: public std::ranges::view_base
+#endif
+	{
+	public:
+		using value_type = std::decay_t<decltype(std::declval<Dist_t&>()(std::declval<Engine_t&>()))>;
+
+		/// <summary>
+		/// End marker of a Sequence.
+		/// </summary>
+		struct Sentinel {};
+
+		class Iterator
+		{
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = Sequence::value_type;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type*;
+			using reference = const value_type&;
+
+			Iterator() = default;
+
+			inline reference operator*() const noexcept { return value; }
+			inline pointer operator->() const noexcept { return &value; }
+
+			inline Iterator& operator++()
+			{
+				if (++index < limit) {
+					value = sequence->Draw();
+				}
+				return *this;
+			}
+
+			/// <summary>
+			/// Moves to the next value and returns an iterator that still holds the previous one,
+			/// so *it++ works as for any input iterator.
+			/// </summary>
+			/// <returns></returns>
+			inline Iterator operator++(int)
+			{
+				Iterator previous = *this;
+				++*this;
+				return previous;
+			}
+
+			friend inline bool operator==(const Iterator& it, Sentinel) noexcept { return it.index >= it.limit; }
+			friend inline bool operator==(Sentinel s, const Iterator& it) noexcept { return it == s; }
+			friend inline bool operator!=(const Iterator& it, Sentinel s) noexcept { return !(it == s); }
+			friend inline bool operator!=(Sentinel s, const Iterator& it) noexcept { return !(it == s); }
+		private:
+			friend class Sequence;
+
+			Sequence* sequence = nullptr;
+			std::uint64_t index = 0;
+			std::uint64_t limit = 0;
+			value_type value{};
+
+			explicit Iterator(Sequence* sequence) : sequence(sequence), limit(sequence->limit)
+			{
+				if (limit != 0) {
+					value = sequence->Draw();
+				}
+			}
+		};
+
+		Sequence() = default;
+
+		/// <summary>
+		/// Creates a range over dist and engine. With RANDOM_ENABLE_STATS defined, steps of the global
+		/// engine are counted against api on whichever thread iterates; Api::Count leaves them uncounted.
+		/// </summary>
+		Sequence(const Dist_t& dist, Engine_t& engine, std::uint64_t limit = ~std::uint64_t(0), Api api = Api::Count)
+			: dist(dist), engine(&engine), limit(limit), api(api)
+		{
+		}
+
+		/// <summary>
+		/// Starts drawing values. Each call to begin continues from the engine's current state.
+		/// </summary>
+		/// <returns></returns>
+		inline Iterator begin() { return Iterator(this); }
+		inline Sentinel end() const noexcept { return {}; }
+
+		/// <summary>
+		/// Returns a copy of this sequence that stops after count values.
+		/// </summary>
+		/// <param name="count">Number of values.</param>
+		/// <returns></returns>
+		inline Sequence Take(std::uint64_t count) const
+		{
+			return Sequence(dist, *engine, std::min(count, limit), api);
+		}
+	private:
+		Dist_t dist{};
+		Engine_t* engine = nullptr;
+		std::uint64_t limit = 0;
+		Api api = Api::Count;
+
+		inline value_type Draw()
+		{
+#ifdef RANDOM_ENABLE_STATS
+			//The wrapper is built per draw rather than kept: the range may be iterated on another
+			//thread, and Use() retargets the thread_local one on every call.
+			if constexpr (std::is_same_v<Engine_t, Engine>) {
+				if (api != Api::Count) {
+					StatsEngine counted{ engine, &LocalStats(), static_cast<std::size_t>(api) };
+					return dist(counted);
+				}
+			}
+#endif
+			return dist(*engine);
+		}
+	};
+private:
+	//Counts a range factory call and returns the engine itself, which a Sequence can keep.
+	inline static Engine& RangeEngine()
+	{
+		Use(Api::Ranges);
+		return Get().rng;
+	}
+public:
+
+	/// <summary>
+	/// Lazy range of integers between begin and end (inclusive) from the global generator.
+	/// </summary>
+	/// <param name="begin"></param>
+	/// <param name="end"></param>
+	/// <returns></returns>
+	template<typename Int_t>
+	inline static Sequence<std::uniform_int_distribution<Int_t>> Ints(Int_t begin, Int_t end)
+	{
+		return { std::uniform_int_distribution<Int_t>(begin, end), RangeEngine(), ~std::uint64_t(0), Api::Ranges };
+	}
+
+	/// <summary>
+	/// Lazy range of floats between min and max (exclusive) from the global generator.
+	/// </summary>
+	/// <param name="min"></param>
+	/// <param name="max"></param>
+	/// <returns></returns>
+	template<typename Float_t>
+	inline static Sequence<std::uniform_real_distribution<Float_t>> Floats(Float_t min, Float_t max)
+	{
+		return { std::uniform_real_distribution<Float_t>(min, max), RangeEngine(), ~std::uint64_t(0), Api::Ranges };
+	}
+
+	/// <summary>
+	/// Lazy range of normally distributed floats from the global generator.
+	/// </summary>
+	/// <param name="mean"></param>
+	/// <param name="stddev"></param>
+	/// <returns></returns>
+	template<typename Float_t>
+	inline static Sequence<Normal<Float_t>> Normals(Float_t mean, Float_t stddev = static_cast<Float_t>(1.0))
+	{
+		return { Normal<Float_t>(mean, stddev), RangeEngine(), ~std::uint64_t(0), Api::Ranges };
+	}
+
+	/// <summary>
+	/// Lazy range of values from any sampler or std distribution, using the global generator.
+	/// </summary>
+	/// <param name="dist">Distribution or sampler.</param>
+	/// <returns></returns>
+	template<typename Dist_t>
+	inline static Sequence<Dist_t> Values(const Dist_t& dist)
+	{
+		return { dist, RangeEngine(), ~std::uint64_t(0), Api::Ranges };
+	}
+
+	/// <summary>
+	/// Lazy range of values from any sampler or std distribution, using the supplied engine.
+	/// The engine must outlive the range.
+	/// </summary>
+	/// <param name="dist">Distribution or sampler.</param>
+	/// <param name="engine">Engine to draw from.</param>
+	/// <returns></returns>
+	template<typename Dist_t, typename Engine_t>
+	inline static Sequence<Dist_t, Engine_t> Values(const Dist_t& dist, Engine_t& engine)
+	{
+		return { dist, engine };
+	}
+
+	/// <summary>
+	/// Number of bytes written by SaveState for the global generator.
+	/// </summary>
+	static constexpr std::size_t StateSize = sizeof(Engine);
+
+	/// <summary>
+	/// Copies the global generator's state into out.
+	/// The format is the engine's in-memory layout, so it is only valid for the same build and platform.
+	/// </summary>
+	/// <param name="out">Destination buffer.</param>
+	/// <param name="size">Size of out in bytes, at least StateSize.</param>
+	/// <returns>Bytes written.</returns>
+	inline static std::size_t SaveState(void* out, std::size_t size)
+	{
+		return SaveState(Get().rng, out, size);
+	}
+
+	/// <summary>
+	/// Restores the global generator from a buffer written by SaveState.
+	/// </summary>
+	/// <param name="in">Source buffer.</param>
+	/// <param name="size">Size of the saved state in bytes, which must be StateSize.</param>
+	/// <returns>Bytes read.</returns>
+	inline static std::size_t RestoreState(const void* in, std::size_t size)
+	{
+		return RestoreState(Get().rng, in, size);
+	}
+
+	/// <summary>
+	/// Copies the state of any engine, Stream or Philox into out.
+	/// </summary>
+	/// <param name="engine">Engine to save.</param>
+	/// <param name="out">Destination buffer.</param>
+	/// <param name="size">Size of out in bytes, at least sizeof(Engine_t).</param>
+	/// <returns>Bytes written.</returns>
+	template<typename Engine_t>
+	inline static std::size_t SaveState(const Engine_t& engine, void* out, std::size_t size)
+	{
+		return SaveStates(&engine, 1, out, size);
+	}
+
+	/// <summary>
+	/// Restores an engine, Stream or Philox from a buffer written by SaveState.
+	/// </summary>
+	/// <param name="engine">Engine to overwrite.</param>
+	/// <param name="in">Source buffer.</param>
+	/// <param name="size">Size of the saved state in bytes, which must be sizeof(Engine_t).</param>
+	/// <returns>Bytes read.</returns>
+	template<typename Engine_t>
+	inline static std::size_t RestoreState(Engine_t& engine, const void* in, std::size_t size)
+	{
+		return RestoreStates(&engine, 1, in, size);
+	}
+
+	/// <summary>
+	/// Copies the states of count contiguous engines into out with a single copy.
+	/// </summary>
+	/// <param name="engines">First engine.</param>
+	/// <param name="count">Number of engines.</param>
+	/// <param name="out">Destination buffer.</param>
+	/// <param name="size">Size of out in bytes, at least count * sizeof(Engine_t).</param>
+	/// <returns>Bytes written.</returns>
+	template<typename Engine_t>
+	inline static std::size_t SaveStates(const Engine_t* engines, std::size_t count, void* out, std::size_t size)
+	{
+		static_assert(std::is_trivially_copyable_v<Engine_t>, "Engine state must be trivially copyable");
+		if (size < count * sizeof(Engine_t)) {
+			throw std::invalid_argument("Random::SaveStates: buffer is too small.");
+		}
+		std::memcpy(out, engines, count * sizeof(Engine_t));
+		return count * sizeof(Engine_t);
+	}
+
+	/// <summary>
+	/// Restores count contiguous engines from a buffer written by SaveStates. A buffer of any other
+	/// size was written for a different engine type or count, or was truncated, and is rejected.
+	/// </summary>
+	/// <param name="engines">First engine.</param>
+	/// <param name="count">Number of engines.</param>
+	/// <param name="in">Source buffer.</param>
+	/// <param name="size">Size of the saved states in bytes, which must be count * sizeof(Engine_t).</param>
+	/// <returns>Bytes read.</returns>
+	template<typename Engine_t>
+	inline static std::size_t RestoreStates(Engine_t* engines, std::size_t count, const void* in, std::size_t size)
+	{
+		static_assert(std::is_trivially_copyable_v<Engine_t>, "Engine state must be trivially copyable");
+		if (size != count * sizeof(Engine_t)) {
+			throw std::invalid_argument("Random::RestoreStates: saved state has the wrong size.");
+		}
+		std::memcpy(engines, in, count * sizeof(Engine_t));
+		return count * sizeof(Engine_t);
+	}
+
+	/// <summary>
+	/// Records a trace of a pcg engine for deterministic replay. The trace is the engine's starting state
+	/// plus tagged marks holding the number of draws made up to that point. Draw counts come from the
+	/// engine distance, so recording costs nothing per draw. On replay, Seek and SeekMark jump to any
+	/// point with advance in O(log n) and Verify detects desyncs.
+	/// Requires an engine with advance and operator-.
+	/// </summary>
+	/// <typeparam name="Engine_t">pcg engine type.</typeparam>
+	template<typename Engine_t = Engine>
+	class BasicRecorder
+	{
+		template<typename E, typename = void>
+		struct IsSeekable : std::false_type {};
+
+		template<typename E>
+		struct IsSeekable<E, std::void_t<
+			decltype(std::declval<E&>().advance(0)),
+			decltype(std::declval<const E&>() - std::declval<const E&>())>> : std::true_type {};
+
+		static_assert(IsSeekable<Engine_t>::value,
+			"Recording needs an engine with advance and operator-");
+	public:
+		struct Mark
+		{
+			std::uint64_t tag;
+			std::uint64_t draws;
+		};
+
+		/// <summary>
+		/// Starts recording the global generator from its current state.
+		/// </summary>
+		template<typename E = Engine_t, std::enable_if_t<std::is_same_v<E, Random::Engine>, int> = 0>
+		BasicRecorder() : BasicRecorder(Get().rng)
+		{
+		}
+
+		/// <summary>
+		/// Starts recording engine from its current state. The engine must outlive the recorder.
+		/// </summary>
+		/// <param name="engine">Engine to record.</param>
+		explicit BasicRecorder(Engine_t& engine) : engine(&engine), origin(engine)
+		{
+		}
+
+		/// <summary>
+		/// Number of draws made by the engine since the origin. This is the pcg distance from the origin
+		/// state, so it means nothing once the engine has been reseeded (by Random::Seed, or the automatic
+		/// reseed in a forked child). Call Restart after reseeding.
+		/// </summary>
+		/// <returns></returns>
+		inline std::uint64_t Draws() const
+		{
+			return static_cast<std::uint64_t>(*engine - origin);
+		}
+
+		/// <summary>
+		/// Appends a mark with the given tag at the current draw count.
+		/// </summary>
+		/// <param name="tag">Call site, frame number or any user value.</param>
+		inline void AddMark(std::uint64_t tag)
+		{
+			marks.push_back({ tag, Draws() });
+		}
+
+		/// <summary>
+		/// Makes the engine's current state the new origin and clears the marks.
+		/// </summary>
+		inline void Restart()
+		{
+			origin = *engine;
+			marks.clear();
+		}
+
+		/// <summary>
+		/// Puts the engine back at the origin.
+		/// </summary>
+		inline void Rewind()
+		{
+			*engine = origin;
+		}
+
+		/// <summary>
+		/// Moves the engine to the state after the given number of draws from the origin.
+		/// </summary>
+		/// <param name="draws"></param>
+		inline void Seek(std::uint64_t draws)
+		{
+			*engine = origin;
+			engine->advance(static_cast<typename Engine_t::state_type>(draws));
+		}
+
+		/// <summary>
+		/// Moves the engine to the state it was in when mark index was added.
+		/// </summary>
+		/// <param name="index"></param>
+		inline void SeekMark(std::size_t index)
+		{
+			assert(index < marks.size());
+			Seek(marks[index].draws);
+		}
+
+		/// <summary>
+		/// Checks during replay that the engine has made exactly as many draws as when mark index was added.
+		/// </summary>
+		/// <param name="index"></param>
+		/// <returns>False if the replay has diverged.</returns>
+		inline bool Verify(std::size_t index) const
+		{
+			return index < marks.size() && marks[index].draws == Draws();
+		}
+
+		inline const std::vector<Mark>& Marks() const noexcept { return marks; }
+		inline const Engine_t& Origin() const noexcept { return origin; }
+
+		/// <summary>
+		/// Size in bytes of the trace written by Save.
+		/// </summary>
+		/// <returns></returns>
+		inline std::size_t TraceSize() const noexcept
+		{
+			return sizeof(Engine_t) + sizeof(std::uint64_t) + marks.size() * sizeof(Mark);
+		}
+
+		/// <summary>
+		/// Writes the origin and marks into out. Uses the same native layout as SaveState.
+		/// </summary>
+		/// <param name="out"></param>
+		/// <param name="size">Size of out in bytes, at least TraceSize().</param>
+		/// <returns>Bytes written.</returns>
+		inline std::size_t Save(void* out, std::size_t size) const
+		{
+			if (size < TraceSize()) {
+				throw std::invalid_argument("Random::Recorder::Save: buffer is too small.");
+			}
+			unsigned char* p = static_cast<unsigned char*>(out);
+			const std::uint64_t count = marks.size();
+			p += SaveState(origin, p, sizeof(Engine_t));
+			std::memcpy(p, &count, sizeof(count));
+			p += sizeof(count);
+			std::memcpy(p, marks.data(), marks.size() * sizeof(Mark));
+			return TraceSize();
+		}
+
+		/// <summary>
+		/// Loads a trace written by Save and rewinds the engine to its origin.
+		/// </summary>
+		/// <param name="in"></param>
+		/// <param name="size">Size of the trace in bytes. A truncated trace is rejected.</param>
+		/// <returns>Bytes read.</returns>
+		inline std::size_t Load(const void* in, std::size_t size)
+		{
+			constexpr std::size_t header = sizeof(Engine_t) + sizeof(std::uint64_t);
+			const unsigned char* p = static_cast<const unsigned char*>(in);
+			std::uint64_t count;
+			if (size < header) {
+				throw std::invalid_argument("Random::Recorder::Load: trace is truncated.");
+			}
+			std::memcpy(&count, p + sizeof(Engine_t), sizeof(count));
+			if (count > (size - header) / sizeof(Mark) || size != header + count * sizeof(Mark)) {
+				throw std::invalid_argument("Random::Recorder::Load: trace has the wrong size.");
+			}
+			p += RestoreState(origin, p, sizeof(Engine_t));
+			p += sizeof(count);
+			marks.resize(count);
+			std::memcpy(marks.data(), p, count * sizeof(Mark));
+			Rewind();
+			return TraceSize();
+		}
+	private:
+		Engine_t* engine;
+		Engine_t origin;
+		std::vector<Mark> marks;
+	};
+
+	/// <summary>
+	/// Recorder for the global generator.
+	/// </summary>
+	using Recorder = BasicRecorder<Engine>;
+
+	/// <summary>
+	/// Returns the instrumentation counters summed over all threads. Define RANDOM_ENABLE_STATS
+	/// before including this header to turn them on. Otherwise the snapshot is empty and enabled is false.
+	/// </summary>
+	/// <returns></returns>
+	inline static StatsSnapshot Stats()
+	{
+		StatsSnapshot snapshot;
+#ifdef RANDOM_ENABLE_STATS
+		StatsRegistry& registry = Registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		snapshot.enabled = true;
+		snapshot.threads = registry.blocks.size();
+		for (const auto& block : registry.blocks) {
+			for (std::size_t i = 0; i < ApiCount; i++) {
+				snapshot.calls[i] += block->calls[i].load(std::memory_order_relaxed);
+				snapshot.steps[i] += block->steps[i].load(std::memory_order_relaxed);
+			}
+			snapshot.rejections += block->rejections.load(std::memory_order_relaxed);
+			snapshot.reseeds += block->reseeds.load(std::memory_order_relaxed);
+		}
+		snapshot.reseeds += forkReseeds.load(std::memory_order_relaxed);
+		for (std::uint64_t steps : snapshot.steps) {
+			snapshot.engineSteps += steps;
+		}
+#endif
+		return snapshot;
+	}
+
+	/// <summary>
+	/// Sets all instrumentation counters back to zero. Counts made by other threads while this runs may be lost.
+	/// </summary>
+	inline static void ResetStats()
+	{
+#ifdef RANDOM_ENABLE_STATS
+		StatsRegistry& registry = Registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (const auto& block : registry.blocks) {
+			for (std::size_t i = 0; i < ApiCount; i++) {
+				block->calls[i].store(0, std::memory_order_relaxed);
+				block->steps[i].store(0, std::memory_order_relaxed);
+			}
+			block->rejections.store(0, std::memory_order_relaxed);
+			block->reseeds.store(0, std::memory_order_relaxed);
+		}
+		forkReseeds.store(0, std::memory_order_relaxed);
+#endif
+	}
+
+#ifdef RANDOM_ENABLE_PROFILER
+	/// <summary>
+	/// Returns the sampled call sites, most expensive first. Only one call in every RANDOM_PROFILER_PERIOD
+	/// per thread is measured, and estimatedCalls scales the sample count back up by that period.
+	/// </summary>
+	/// <returns></returns>
+	inline static std::vector<ProfileEntry> Profile()
+	{
+		std::vector<ProfileEntry> entries;
+		for (const ProfileSlot& slot : Profiler().slots) {
+			if (slot.state.load(std::memory_order_acquire) != 2) {
+				continue;
+			}
+			const std::uint64_t samples = slot.samples.load(std::memory_order_relaxed);
+			entries.push_back({ slot.file, slot.function, slot.line, samples, samples * RANDOM_PROFILER_PERIOD,
+				slot.cycles.load(std::memory_order_relaxed), slot.draws.load(std::memory_order_relaxed) });
+		}
+		std::sort(entries.begin(), entries.end(), [](const ProfileEntry& a, const ProfileEntry& b) { return a.cycles > b.cycles; });
+		return entries;
+	}
+
+	/// <summary>
+	/// Number of samples that were lost because the call site table was full.
+	/// </summary>
+	/// <returns></returns>
+	inline static std::uint64_t ProfileDropped()
+	{
+		return Profiler().dropped.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Clears the sampled totals. Call sites stay in the table.
+	/// </summary>
+	inline static void ResetProfile()
+	{
+		ProfileTable& table = Profiler();
+		for (ProfileSlot& slot : table.slots) {
+			slot.samples.store(0, std::memory_order_relaxed);
+			slot.cycles.store(0, std::memory_order_relaxed);
+			slot.draws.store(0, std::memory_order_relaxed);
+		}
+		table.dropped.store(0, std::memory_order_relaxed);
+	}
+#endif
+
+#ifdef RANDOM_HAS_POSIX
+private:
+	[[noreturn]] inline static void ThrowErrno(const std::string& what)
+	{
+		throw std::system_error(errno, std::generic_category(), what);
+	}
+
+	//Owns a file descriptor.
+	class FileHandle
+	{
+	public:
+		explicit FileHandle(int fd) : fd(fd) {}
+		FileHandle(const std::string& path, int flags, mode_t mode = 0644) : fd(::open(path.c_str(), flags | O_CLOEXEC, mode))
+		{
+			if (fd < 0) {
+				ThrowErrno("open " + path);
+			}
+		}
+		FileHandle(const FileHandle&) = delete;
+		FileHandle& operator=(const FileHandle&) = delete;
+		~FileHandle()
+		{
+			if (fd >= 0) {
+				::close(fd);
+			}
+		}
+
+		inline struct stat Stat() const
+		{
+			struct stat st;
+			if (::fstat(fd, &st) != 0) {
+				ThrowErrno("fstat");
+			}
+			return st;
+		}
+
+		inline size_t Size() const
+		{
+			const struct stat st = Stat();
+			if (static_cast<std::uint64_t>(st.st_size) > std::numeric_limits<size_t>::max()) {
+				throw std::system_error(EFBIG, std::generic_category(), "file does not fit in the address space");
+			}
+			return static_cast<size_t>(st.st_size);
+		}
+
+		int fd;
+	};
+
+	//Owns a shared mapping of a whole file. Empty files are not mapped.
+	class FileMapping
+	{
+	public:
+		FileMapping(int fd, size_t size, int prot, int advice) : size(size)
+		{
+			if (size == 0) {
+				return;
+			}
+			void* p = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+			if (p == MAP_FAILED) {
+				ThrowErrno("mmap");
+			}
+			data = static_cast<unsigned char*>(p);
+			::madvise(p, size, advice); //only a hint, so failure is ignored
+		}
+		FileMapping(const FileMapping&) = delete;
+		FileMapping& operator=(const FileMapping&) = delete;
+		~FileMapping()
+		{
+			if (data) {
+				::munmap(data, size);
+			}
+		}
+
+		unsigned char* data = nullptr;
+		size_t size;
+	};
+
+	inline static void WriteAll(int fd, const void* data, size_t size, off_t offset)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		while (size > 0) {
+			const ssize_t n = ::pwrite(fd, bytes, size, offset);
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				ThrowErrno("pwrite");
+			}
+			bytes += n;
+			size -= static_cast<size_t>(n);
+			offset += n;
+		}
+	}
+
+	inline static void ReadAll(int fd, void* data, size_t size, off_t offset)
+	{
+		unsigned char* bytes = static_cast<unsigned char*>(data);
+		while (size > 0) {
+			const ssize_t n = ::pread(fd, bytes, size, offset);
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				ThrowErrno("pread");
+			}
+			if (n == 0) {
+				throw std::system_error(EIO, std::generic_category(), "unexpected end of file");
+			}
+			bytes += n;
+			size -= static_cast<size_t>(n);
+			offset += n;
+		}
+	}
+
+	inline static void WriteAll(int fd, const void* data, size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		while (size > 0) {
+			const ssize_t n = ::write(fd, bytes, size);
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				ThrowErrno("write");
+			}
+			bytes += n;
+			size -= static_cast<size_t>(n);
+		}
+	}
+
+	static constexpr size_t PageAlignment = 4096;
+
+	struct PageDelete
+	{
+		inline void operator()(std::uint32_t* p) const
+		{
+			::operator delete(p, std::align_val_t(PageAlignment));
+		}
+	};
+
+	//Generates into a page-aligned buffer (so the descriptor may be opened with O_DIRECT) and writes it out.
+	template <typename Engine_t>
+	inline static void WriteBytes_Impl(Engine_t& engine, int fd, std::uint64_t size, size_t bufferSize)
+	{
+		bufferSize = std::max(bufferSize / PageAlignment, size_t(1)) * PageAlignment;
+		const std::unique_ptr<std::uint32_t[], PageDelete> buffer(
+			static_cast<std::uint32_t*>(::operator new(bufferSize, std::align_val_t(PageAlignment))));
+		ByteEngine bulk = MakeByteEngine(engine);
+		while (size > 0) {
+			const size_t n = static_cast<size_t>(std::min<std::uint64_t>(size, bufferSize));
+			bulk.generate(buffer.get(), (n + 3) / 4);
+			WriteAll(fd, buffer.get(), n);
+			size -= n;
+		}
+	}
+
+	//Anonymous temporary file in the same directory as path, so it lives on the same file system.
+	inline static int CreateTempFile(const std::string& path)
+	{
+		std::string name = path + ".shuffleXXXXXX";
+		const int fd = ::mkstemp(&name[0]);
+		if (fd < 0) {
+			ThrowErrno("mkstemp " + name);
+		}
+		::unlink(name.c_str());
+		return fd;
+	}
+
+	//Inside-out Fisher-Yates over fixed-size byte records, see ShuffleInto_Impl.
+	template <typename Engine_t>
+	inline static void ShuffleRecordsInto_Impl(Engine_t& engine, const unsigned char* src, size_t count, size_t recordSize, unsigned char* out)
+	{
+		using Dist_t = std::uniform_int_distribution<size_t>;
+		if (count == 0) {
+			return;
+		}
+		Dist_t dis;
+		std::memcpy(out, src, recordSize);
+		for (size_t i = 1; i < count; i++) {
+			const size_t j = dis(engine, typename Dist_t::param_type(0, i));
+			if (j != i) {
+				std::memcpy(out + i * recordSize, out + j * recordSize, recordSize);
+			}
+			std::memcpy(out + j * recordSize, src + i * recordSize, recordSize);
+		}
+	}
+
+	//External shuffle. Every record is sent to a random bucket, then each bucket is loaded and shuffled
+	//in memory. Random buckets followed by uniform shuffles within each bucket give a uniform permutation.
+	//The bucket choices come from a local pcg32 so they can be drawn twice: once to size the buckets and
+	//once to scatter into them. The buckets are contiguous regions of a single scratch file, which is the
+	//output itself unless the shuffle is in place.
+	template <typename Engine_t>
+	inline static void ShuffleFile_Impl(Engine_t& engine, const std::string& inPath, const std::string& outPath, size_t recordSize, size_t memoryBudget)
+	{
+		if (recordSize == 0) {
+			throw std::invalid_argument("Random::ShuffleFile: recordSize must be greater than 0.");
+		}
+		FileHandle in(inPath, O_RDONLY);
+		const struct stat inStat = in.Stat();
+		const size_t size = in.Size();
+		if (size % recordSize != 0) {
+			throw std::invalid_argument("Random::ShuffleFile: file size is not a multiple of recordSize.");
+		}
+		const size_t count = size / recordSize;
+
+		struct stat outStat;
+		const bool inPlace = ::stat(outPath.c_str(), &outStat) == 0 && outStat.st_dev == inStat.st_dev && outStat.st_ino == inStat.st_ino;
+		FileHandle out(outPath, inPlace ? O_RDWR : O_RDWR | O_CREAT | O_TRUNC);
+		if (::ftruncate(out.fd, static_cast<off_t>(size)) != 0) {
+			ThrowErrno("ftruncate " + outPath);
+		}
+		if (count == 0) {
+			return;
+		}
+
+		//With buckets of half the budget there are about 2 * size / budget of them, and the scatter buffers
+		//share the other half. Giving each buffer MinBufferRecords records takes a budget of at least
+		//2 * sqrt(MinBufferRecords * size * recordSize); below that the scatter would write record by record.
+		constexpr size_t MinBufferRecords = 4;
+		const double minBudget = 2 * std::sqrt(static_cast<double>(MinBufferRecords) * static_cast<double>(size) * static_cast<double>(recordSize));
+		memoryBudget = std::max(memoryBudget, static_cast<size_t>(std::ceil(minBudget)));
+
+		//aim for buckets of half the budget, so the random spread rarely pushes one over it
+		const size_t bucketTarget = std::max(memoryBudget / 2, recordSize) / recordSize;
+		const size_t bucketCount = (count + bucketTarget - 1) / bucketTarget;
+		std::vector<unsigned char> records;
+
+		if (bucketCount == 1) {
+			const FileMapping src(in.fd, size, PROT_READ, MADV_SEQUENTIAL);
+			records.assign(src.data, src.data + size);
+		}
+		else {
+			FileHandle temp(inPlace ? CreateTempFile(outPath) : -1);
+			const int scratch = inPlace ? temp.fd : out.fd;
+
+			const auto bucketState = engine();
+			const auto bucketStream = engine();
+			pcg32 buckets(bucketState, bucketStream);
+			const pcg32 replay = buckets;
+			//each pick is a fresh bounded draw, so replaying the engine replays the picks exactly
+			const auto pick = [&] { return GetInt_Impl<pcg32, size_t>(buckets, 0, bucketCount - 1); };
+			std::vector<size_t> offsets(bucketCount + 1, 0);
+			for (size_t i = 0; i < count; i++) {
+				offsets[pick() + 1] += recordSize;
+			}
+			for (size_t b = 0; b < bucketCount; b++) {
+				offsets[b + 1] += offsets[b];
+			}
+
+			//scatter through one write buffer per bucket, together about half the budget
+			const size_t bufferRecords = std::clamp<size_t>(memoryBudget / 2 / bucketCount / recordSize, 1, (size_t(1) << 20) / recordSize + 1);
+			std::vector<unsigned char> buffers(bucketCount * bufferRecords * recordSize);
+			std::vector<size_t> filled(bucketCount, 0);
+			std::vector<size_t> written(offsets.begin(), offsets.end() - 1);
+			{
+				const FileMapping src(in.fd, size, PROT_READ, MADV_SEQUENTIAL);
+				buckets = replay;
+				for (size_t i = 0; i < count; i++) {
+					const size_t b = pick();
+					unsigned char* buffer = buffers.data() + b * bufferRecords * recordSize;
+					std::memcpy(buffer + filled[b] * recordSize, src.data + i * recordSize, recordSize);
+					if (++filled[b] == bufferRecords) {
+						WriteAll(scratch, buffer, bufferRecords * recordSize, static_cast<off_t>(written[b]));
+						written[b] += bufferRecords * recordSize;
+						filled[b] = 0;
+					}
+				}
+			}
+			for (size_t b = 0; b < bucketCount; b++) {
+				WriteAll(scratch, buffers.data() + b * bufferRecords * recordSize, filled[b] * recordSize, static_cast<off_t>(written[b]));
+			}
+			buffers = std::vector<unsigned char>();
+
+			const FileMapping dst(out.fd, size, PROT_READ | PROT_WRITE, MADV_SEQUENTIAL);
+			for (size_t b = 0; b < bucketCount; b++) {
+				const size_t bytes = offsets[b + 1] - offsets[b];
+				records.resize(bytes);
+				ReadAll(scratch, records.data(), bytes, static_cast<off_t>(offsets[b]));
+				ShuffleRecordsInto_Impl(engine, records.data(), bytes / recordSize, recordSize, dst.data + offsets[b]);
+			}
+			return;
+		}
+
+		const FileMapping dst(out.fd, size, PROT_READ | PROT_WRITE, MADV_SEQUENTIAL);
+		ShuffleRecordsInto_Impl(engine, records.data(), count, recordSize, dst.data);
+	}
+
+	//Floyd's algorithm picks k distinct records, which are then copied in file order so the reads only
+	//move forward. Sequential read-ahead is requested when the picks average at least one per page.
+	template <typename Engine_t>
+	inline static std::vector<unsigned char> SampleFile_Impl(Engine_t& engine, const std::string& path, size_t recordSize, size_t k)
+	{
+		if (recordSize == 0) {
+			throw std::invalid_argument("Random::SampleFile: recordSize must be greater than 0.");
+		}
+		FileHandle file(path, O_RDONLY);
+		const size_t size = file.Size();
+		if (size % recordSize != 0) {
+			throw std::invalid_argument("Random::SampleFile: file size is not a multiple of recordSize.");
+		}
+		const size_t count = size / recordSize;
+		if (k > count) {
+			throw std::invalid_argument("Random::SampleFile: k is larger than the number of records.");
+		}
+
+		std::unordered_set<size_t> chosen;
+		chosen.reserve(k);
+		for (size_t j = count - k; j < count; j++) {
+			const size_t t = GetInt_Impl<Engine_t, size_t>(engine, 0, j);
+			chosen.insert(chosen.count(t) ? j : t);
+		}
+		std::vector<size_t> indices(chosen.begin(), chosen.end());
+		std::sort(indices.begin(), indices.end());
+
+		std::vector<unsigned char> sample(k * recordSize);
+		if (k == 0) {
+			return sample;
+		}
+		const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		const bool dense = size / k <= page;
+		const FileMapping src(file.fd, size, PROT_READ, dense ? MADV_SEQUENTIAL : MADV_RANDOM);
+		for (size_t i = 0; i < k; i++) {
+			std::memcpy(sample.data() + i * recordSize, src.data + indices[i] * recordSize, recordSize);
+		}
+		return sample;
+	}
+
+public:
+	/// <summary>
+	/// Shuffles a file of fixed-size records in place, without loading it into memory. Records are
+	/// scattered into random buckets of about memoryBudget / 2 bytes, which are then shuffled in memory
+	/// one at a time. A temporary file next to path holds the buckets.
+	/// Throws std::system_error on I/O errors and std::invalid_argument if the file size is not a
+	/// multiple of recordSize.
+	/// </summary>
+	/// <param name="path">File to shuffle.</param>
+	/// <param name="recordSize">Size of each record in bytes.</param>
+	/// <param name="memoryBudget">Approximate memory to use, in bytes. Raised to about
+	/// 4 * sqrt(file size * recordSize) if smaller, 0 included, so the scatter writes are never record by record.</param>
+	inline static void ShuffleFile(const std::string& path, size_t recordSize, size_t memoryBudget = RANDOM_FILE_MEMORY_BUDGET RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		ShuffleFile_Impl(Use(Api::Files), path, path, recordSize, memoryBudget);
+	}
+
+	/// <summary>
+	/// Writes the records of inPath to outPath in random order. The output file is used to hold the
+	/// buckets, so no temporary file is needed. If both paths name the same file, it is shuffled in place.
+	/// </summary>
+	/// <param name="inPath">File to read.</param>
+	/// <param name="outPath">File to create or overwrite.</param>
+	/// <param name="recordSize">Size of each record in bytes.</param>
+	/// <param name="memoryBudget">Approximate memory to use, in bytes, raised to the same minimum as above.</param>
+	inline static void ShuffleFile(const std::string& inPath, const std::string& outPath, size_t recordSize,
+		size_t memoryBudget = RANDOM_FILE_MEMORY_BUDGET RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		ShuffleFile_Impl(Use(Api::Files), inPath, outPath, recordSize, memoryBudget);
+	}
+
+	/// <summary>
+	/// Picks k distinct records from a file of fixed-size records, each subset being equally likely.
+	/// The records are returned back to back in file order. Throws std::invalid_argument if k is larger
+	/// than the number of records.
+	/// </summary>
+	/// <param name="path">File to sample.</param>
+	/// <param name="recordSize">Size of each record in bytes.</param>
+	/// <param name="k">Number of records.</param>
+	/// <returns>k * recordSize bytes.</returns>
+	inline static std::vector<unsigned char> SampleFile(const std::string& path, size_t recordSize, size_t k RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		return SampleFile_Impl(Use(Api::Files), path, recordSize, k);
+	}
+
+	/// <summary>
+	/// Writes size random bytes to a file descriptor, for test fixtures or burn-in data. The bytes are
+	/// generated a buffer at a time into a page-aligned buffer by a multi-lane engine seeded from the
+	/// global one. Works with pipes and sockets as well as files. Throws std::system_error if a write fails.
+	/// </summary>
+	/// <param name="fd">File descriptor to write to.</param>
+	/// <param name="size">Number of bytes.</param>
+	/// <param name="bufferSize">Size of the write buffer in bytes, rounded down to whole pages.</param>
+	inline static void WriteBytes(int fd, std::uint64_t size, size_t bufferSize = RANDOM_WRITE_BUFFER_SIZE RANDOM_CALL_SITE)
+	{
+		RANDOM_PROFILE_CALL;
+		WriteBytes_Impl(Use(Api::GetByte), fd, size, bufferSize);
 	}
+#endif
 };
 
 #endif
\ No newline at end of file
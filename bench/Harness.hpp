@@ -0,0 +1,193 @@
+///Timing harness shared by the Random benchmarks.
+#ifndef RANDOM_BENCH_HARNESS_HPP
+#define RANDOM_BENCH_HARNESS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Bench
+{
+	/// <summary>
+	/// Keeps the compiler from discarding a value that is otherwise unused.
+	/// </summary>
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const T* sink;
+		sink = &value;
+#endif
+	}
+
+	struct Options
+	{
+		std::string filter;
+		std::string json;
+		std::size_t repetitions = 5;
+		double minTimeMs = 20.0;
+		std::size_t shuffleMax = std::size_t(1) << 20;
+
+		/// <summary>
+		/// Parses --filter, --json, --reps, --min-time-ms and --shuffle-max. Unknown arguments are
+		/// left for the caller in rest.
+		/// </summary>
+		static Options Parse(int argc, char** argv, std::vector<std::string>* rest = nullptr)
+		{
+			Options options;
+			for (int i = 1; i < argc; i++) {
+				const std::string arg = argv[i];
+				const bool hasValue = i + 1 < argc;
+				if (arg == "--filter" && hasValue) {
+					options.filter = argv[++i];
+				} else if (arg == "--json" && hasValue) {
+					options.json = argv[++i];
+				} else if (arg == "--reps" && hasValue) {
+					options.repetitions = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+				} else if (arg == "--min-time-ms" && hasValue) {
+					options.minTimeMs = std::strtod(argv[++i], nullptr);
+				} else if (arg == "--shuffle-max" && hasValue) {
+					options.shuffleMax = static_cast<std::size_t>(std::strtod(argv[++i], nullptr));
+				} else if (rest) {
+					rest->push_back(arg);
+				} else {
+					std::fprintf(stderr, "unknown argument %s\n"
+						"usage: %s [--filter text] [--json file] [--reps n] [--min-time-ms ms] [--shuffle-max n]\n",
+						arg.c_str(), argv[0]);
+					std::exit(2);
+				}
+			}
+			return options;
+		}
+	};
+
+	struct Result
+	{
+		std::string name;
+		double nsPerItem;
+		double madNs;
+		double gbPerSec;
+		std::size_t repetitions;
+	};
+
+	inline double Median(std::vector<double> values)
+	{
+		std::sort(values.begin(), values.end());
+		const std::size_t n = values.size();
+		return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+	}
+
+	/// <summary>
+	/// Median absolute deviation, scaled to match the standard deviation for normal data.
+	/// </summary>
+	inline double Mad(const std::vector<double>& values, double median)
+	{
+		std::vector<double> deviations;
+		deviations.reserve(values.size());
+		for (double v : values) {
+			deviations.push_back(std::fabs(v - median));
+		}
+		return 1.4826 * Median(deviations);
+	}
+
+	class Runner
+	{
+	public:
+		explicit Runner(const Options& options) : options(options)
+		{
+		}
+
+		/// <summary>
+		/// Times fn, which must process itemsPerCall items of bytesPerItem output bytes each.
+		/// The call count is calibrated so each repetition runs for at least minTimeMs, and the
+		/// median and MAD of the per-item time across repetitions are reported.
+		/// </summary>
+		template<typename Fn>
+		const Result* Run(const std::string& name, std::size_t itemsPerCall, std::size_t bytesPerItem, Fn&& fn)
+		{
+			if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+				return nullptr;
+			}
+
+			using Clock = std::chrono::steady_clock;
+			const double minTimeNs = options.minTimeMs * 1e6;
+
+			fn();
+			std::size_t calls = 1;
+			for (;;) {
+				const auto start = Clock::now();
+				for (std::size_t i = 0; i < calls; i++) {
+					fn();
+				}
+				const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+				if (ns >= minTimeNs || calls >= (std::size_t(1) << 40)) {
+					break;
+				}
+				const double scale = ns > 0 ? 1.2 * minTimeNs / ns : 10.0;
+				calls = static_cast<std::size_t>(calls * std::min(std::max(scale, 1.5), 100.0));
+			}
+
+			std::vector<double> samples;
+			for (std::size_t r = 0; r < options.repetitions; r++) {
+				const auto start = Clock::now();
+				for (std::size_t i = 0; i < calls; i++) {
+					fn();
+				}
+				const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+				samples.push_back(ns / (static_cast<double>(calls) * itemsPerCall));
+			}
+
+			Result result;
+			result.name = name;
+			result.nsPerItem = Median(samples);
+			result.madNs = Mad(samples, result.nsPerItem);
+			result.gbPerSec = bytesPerItem / result.nsPerItem;
+			result.repetitions = options.repetitions;
+			results.push_back(result);
+
+			std::printf("%-44s %12.3f ns/op %10.3f GB/s  (+/- %.3f)\n",
+				result.name.c_str(), result.nsPerItem, result.gbPerSec, result.madNs);
+			std::fflush(stdout);
+			return &results.back();
+		}
+
+		inline const std::vector<Result>& Results() const noexcept { return results; }
+
+		/// <summary>
+		/// Writes all results as a JSON object keyed by benchmark name. Does nothing if no file was given.
+		/// </summary>
+		bool WriteJson() const
+		{
+			if (options.json.empty()) {
+				return true;
+			}
+			std::FILE* file = std::fopen(options.json.c_str(), "w");
+			if (!file) {
+				std::perror(options.json.c_str());
+				return false;
+			}
+			std::fprintf(file, "{\n");
+			for (std::size_t i = 0; i < results.size(); i++) {
+				const Result& r = results[i];
+				std::fprintf(file, "  \"%s\": { \"ns_per_op\": %.6g, \"mad_ns\": %.6g, \"gb_per_s\": %.6g, \"reps\": %zu }%s\n",
+					r.name.c_str(), r.nsPerItem, r.madNs, r.gbPerSec, r.repetitions, i + 1 < results.size() ? "," : "");
+			}
+			std::fprintf(file, "}\n");
+			std::fclose(file);
+			return true;
+		}
+	private:
+		Options options;
+		std::vector<Result> results;
+	};
+}
+
+#endif
@@ -0,0 +1,196 @@
+///Microbenchmarks for the public Random API, compared against std::mt19937 and raw pcg32.
+#include "Random.hpp"
+#include "Harness.hpp"
+
+#include <memory_resource>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr std::size_t Batch = 1024;
+
+	template<typename Fn>
+	void Scalar(Bench::Runner& runner, const std::string& name, std::size_t bytes, Fn&& fn)
+	{
+		runner.Run(name, Batch, bytes, [&] {
+			for (std::size_t i = 0; i < Batch; i++) {
+				Bench::DoNotOptimize(fn());
+			}
+		});
+	}
+
+	template<typename Int_t>
+	void GetInt(Bench::Runner& runner, const char* type)
+	{
+		const Int_t begin = std::numeric_limits<Int_t>::min() / 2 + 3;
+		const Int_t end = std::numeric_limits<Int_t>::max() / 3;
+		Scalar(runner, std::string("GetInt<") + type + ">", sizeof(Int_t), [=] { return Random::GetInt(begin, end); });
+		Scalar(runner, std::string("GetInt<") + type + "> small range", sizeof(Int_t), [] { return Random::GetInt<Int_t>(1, 6); });
+	}
+
+	template<typename Int_t, std::size_t N>
+	void GetIntArray(Bench::Runner& runner, const char* type)
+	{
+		runner.Run(std::string("GetIntArray<") + type + ", " + std::to_string(N) + ">", N, sizeof(Int_t), [] {
+			std::array<Int_t, N> values = Random::GetIntArray<N, Int_t>(0, 1000);
+			Bench::DoNotOptimize(values);
+		});
+	}
+
+	template<typename Float_t, std::size_t N>
+	void GetFloatArray(Bench::Runner& runner, const char* type)
+	{
+		runner.Run(std::string("GetFloatArray<") + type + ", " + std::to_string(N) + ">", N, sizeof(Float_t), [] {
+			std::array<Float_t, N> values = Random::GetFloatArray<N, Float_t>(0, 1);
+			Bench::DoNotOptimize(values);
+		});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const Bench::Options options = Bench::Options::Parse(argc, argv);
+	Bench::Runner runner(options);
+	Random::Seed(42u);
+
+	std::mt19937 mt(42);
+	std::mt19937_64 mt64(42);
+	pcg32 pcg(42, 54);
+
+	//baselines
+	Scalar(runner, "raw std::mt19937", 4, [&] { return mt(); });
+	Scalar(runner, "raw std::mt19937_64", 8, [&] { return mt64(); });
+	Scalar(runner, "raw pcg32", 4, [&] { return pcg(); });
+	Scalar(runner, "std::uniform_int_distribution<int> mt19937", 4, [&] {
+		return std::uniform_int_distribution<int>(1, 6)(mt);
+	});
+	Scalar(runner, "std::uniform_real_distribution<double> mt19937", 8, [&] {
+		return std::uniform_real_distribution<double>(0.0, 1.0)(mt);
+	});
+	Scalar(runner, "std::normal_distribution<double> mt19937", 8, [&] {
+		static std::normal_distribution<double> normal;
+		return normal(mt);
+	});
+	runner.Run("std::shuffle mt19937 n=4096", 4096, 4, [&] {
+		static std::vector<int> values(4096);
+		std::shuffle(values.begin(), values.end(), mt);
+		Bench::DoNotOptimize(values.data());
+	});
+
+	//integers
+	GetInt<std::int16_t>(runner, "int16_t");
+	GetInt<std::uint16_t>(runner, "uint16_t");
+	GetInt<std::int32_t>(runner, "int32_t");
+	GetInt<std::uint32_t>(runner, "uint32_t");
+	GetInt<std::int64_t>(runner, "int64_t");
+	GetInt<std::uint64_t>(runner, "uint64_t");
+	Scalar(runner, "GetByte", 1, [] { return Random::GetByte(); });
+	Scalar(runner, "GetIntBinomial<int> t=100 p=0.3", 4, [] { return Random::GetIntBinomial(100, 0.3); });
+
+	//bytes
+	for (std::size_t n : { std::size_t(64), std::size_t(4096), std::size_t(1) << 20 }) {
+		std::vector<unsigned char> bytes(n);
+		runner.Run("FillBytes n=" + std::to_string(n), n, 1, [&] {
+			Random::FillBytes(bytes.data(), bytes.size());
+			Bench::DoNotOptimize(bytes.data());
+		});
+	}
+#ifdef RANDOM_HAS_POSIX
+	{
+		const int devNull = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+		if (devNull >= 0) {
+			const std::size_t n = std::size_t(16) << 20;
+			runner.Run("WriteBytes /dev/null n=" + std::to_string(n), n, 1, [&] { Random::WriteBytes(devNull, n); });
+			::close(devNull);
+		}
+	}
+#endif
+
+	//floats
+	Scalar(runner, "GetFloat<float>", 4, [] { return Random::GetFloat(0.0f, 1.0f); });
+	Scalar(runner, "GetFloat<double>", 8, [] { return Random::GetFloat(0.0, 1.0); });
+	Scalar(runner, "GetFloatNormal<float>", 4, [] { return Random::GetFloatNormal(0.0f, 1.0f); });
+	Scalar(runner, "GetFloatNormal<double>", 8, [] { return Random::GetFloatNormal(0.0, 1.0); });
+
+	//chance
+	Scalar(runner, "Chance(double)", 1, [] { return Random::Chance(0.3); });
+	Scalar(runner, "Chance(n, d)", 1, [] { return Random::Chance(3, 10); });
+
+	//strings
+	const std::pair<const char*, const char*> charsets[] = {
+		{ "Base64", Random::Charset::Base64 },
+		{ "Alpha", Random::Charset::Alpha },
+		{ "AlphaNum", Random::Charset::AlphaNum },
+		{ "Numeric", Random::Charset::Numeric },
+		{ "Hex", Random::Charset::Hex },
+		{ "Binary", Random::Charset::Binary },
+	};
+	for (const auto& charset : charsets) {
+		const std::string_view chars = charset.second;
+		runner.Run(std::string("GetString ") + charset.first + " len=64", 64, 1, [=] {
+			Bench::DoNotOptimize(Random::GetString(chars, 64));
+		});
+	}
+	runner.Run("GetString 'a'..'z' len=64", 64, 1, [] {
+		Bench::DoNotOptimize(Random::GetString('a', 'z', 64));
+	});
+
+	//shuffle
+	for (std::size_t n : { std::size_t(16), std::size_t(256), std::size_t(4096), std::size_t(65536),
+		std::size_t(1) << 20, std::size_t(1) << 24, std::size_t(100000000) }) {
+		if (n > options.shuffleMax) {
+			continue;
+		}
+		std::vector<int> values(n);
+		std::iota(values.begin(), values.end(), 0);
+		runner.Run("Shuffle n=" + std::to_string(n), n, sizeof(int), [&] {
+			Random::Shuffle(values);
+			Bench::DoNotOptimize(values.data());
+		});
+		runner.Run("ShuffleCopy n=" + std::to_string(n), n, sizeof(int), [&] {
+			Bench::DoNotOptimize(Random::ShuffleCopy(values).data());
+		});
+		std::vector<int> out(n);
+		runner.Run("ShuffleInto n=" + std::to_string(n), n, sizeof(int), [&] {
+			Bench::DoNotOptimize(Random::ShuffleInto(values.begin(), values.end(), out.begin()));
+		});
+	}
+
+	//arrays
+	GetIntArray<int, 16>(runner, "int");
+	GetIntArray<int, 256>(runner, "int");
+	GetFloatArray<float, 16>(runner, "float");
+	GetFloatArray<double, 256>(runner, "double");
+	for (std::size_t n : { 256, 65536 }) {
+		runner.Run("GetIntVector<int> n=" + std::to_string(n), n, sizeof(int), [n] {
+			Bench::DoNotOptimize(Random::GetIntVector(n, 0, 1000).data());
+		});
+		std::vector<std::byte> storage(n * sizeof(int) + 64);
+		runner.Run("GetIntVector<int> pmr arena n=" + std::to_string(n), n, sizeof(int), [&, n] {
+			std::pmr::monotonic_buffer_resource arena(storage.data(), storage.size(), std::pmr::null_memory_resource());
+			Bench::DoNotOptimize(Random::GetIntVector(n, 0, 1000, &arena).data());
+		});
+		runner.Run("GetFloatVector<double> n=" + std::to_string(n), n, sizeof(double), [n] {
+			Bench::DoNotOptimize(Random::GetFloatVector(n, 0.0, 1.0).data());
+		});
+	}
+
+	//other generators
+	{
+		Random::Stream stream(42, 7);
+		Scalar(runner, "Stream GetInt<int>", 4, [&] { return stream.GetInt(1, 6); });
+		Random::Philox philox(42);
+		Scalar(runner, "raw Philox", 4, [&] { return philox(); });
+		std::uint64_t id = 0;
+		Scalar(runner, "Hash", 8, [&] { return Random::Hash(42, id++); });
+		std::vector<double> normals(4096);
+		runner.Run("Normal<double>::Fill n=4096", normals.size(), 8, [&] {
+			Random::Normal<double>().Fill(normals.begin(), normals.end());
+			Bench::DoNotOptimize(normals.data());
+		});
+	}
+
+	return runner.WriteJson() ? 0 : 1;
+}
@@ -0,0 +1,309 @@
+///Compares every engine typedef in pcg_random.hpp for throughput, latency and advance cost.
+#include "Random.hpp"
+#include "Harness.hpp"
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#define RANDOM_BENCH_PCG_ENGINES(X) \
+	X(pcg_engines::oneseq_xsh_rs_16_8) \
+	X(pcg_engines::oneseq_xsh_rs_32_16) \
+	X(pcg_engines::oneseq_xsh_rs_64_32) \
+	X(pcg_engines::oneseq_xsh_rs_128_64) \
+	X(pcg_engines::cm_oneseq_xsh_rs_128_64) \
+	X(pcg_engines::unique_xsh_rs_16_8) \
+	X(pcg_engines::unique_xsh_rs_32_16) \
+	X(pcg_engines::unique_xsh_rs_64_32) \
+	X(pcg_engines::unique_xsh_rs_128_64) \
+	X(pcg_engines::cm_unique_xsh_rs_128_64) \
+	X(pcg_engines::setseq_xsh_rs_16_8) \
+	X(pcg_engines::setseq_xsh_rs_32_16) \
+	X(pcg_engines::setseq_xsh_rs_64_32) \
+	X(pcg_engines::setseq_xsh_rs_128_64) \
+	X(pcg_engines::cm_setseq_xsh_rs_128_64) \
+	X(pcg_engines::mcg_xsh_rs_16_8) \
+	X(pcg_engines::mcg_xsh_rs_32_16) \
+	X(pcg_engines::mcg_xsh_rs_64_32) \
+	X(pcg_engines::mcg_xsh_rs_128_64) \
+	X(pcg_engines::cm_mcg_xsh_rs_128_64) \
+	X(pcg_engines::oneseq_xsh_rr_16_8) \
+	X(pcg_engines::oneseq_xsh_rr_32_16) \
+	X(pcg_engines::oneseq_xsh_rr_64_32) \
+	X(pcg_engines::oneseq_xsh_rr_128_64) \
+	X(pcg_engines::cm_oneseq_xsh_rr_128_64) \
+	X(pcg_engines::unique_xsh_rr_16_8) \
+	X(pcg_engines::unique_xsh_rr_32_16) \
+	X(pcg_engines::unique_xsh_rr_64_32) \
+	X(pcg_engines::unique_xsh_rr_128_64) \
+	X(pcg_engines::cm_unique_xsh_rr_128_64) \
+	X(pcg_engines::setseq_xsh_rr_16_8) \
+	X(pcg_engines::setseq_xsh_rr_32_16) \
+	X(pcg_engines::setseq_xsh_rr_64_32) \
+	X(pcg_engines::setseq_xsh_rr_128_64) \
+	X(pcg_engines::cm_setseq_xsh_rr_128_64) \
+	X(pcg_engines::mcg_xsh_rr_16_8) \
+	X(pcg_engines::mcg_xsh_rr_32_16) \
+	X(pcg_engines::mcg_xsh_rr_64_32) \
+	X(pcg_engines::mcg_xsh_rr_128_64) \
+	X(pcg_engines::cm_mcg_xsh_rr_128_64) \
+	X(pcg_engines::oneseq_rxs_m_xs_8_8) \
+	X(pcg_engines::oneseq_rxs_m_xs_16_16) \
+	X(pcg_engines::oneseq_rxs_m_xs_32_32) \
+	X(pcg_engines::oneseq_rxs_m_xs_64_64) \
+	X(pcg_engines::oneseq_rxs_m_xs_128_128) \
+	X(pcg_engines::cm_oneseq_rxs_m_xs_128_128) \
+	X(pcg_engines::unique_rxs_m_xs_8_8) \
+	X(pcg_engines::unique_rxs_m_xs_16_16) \
+	X(pcg_engines::unique_rxs_m_xs_32_32) \
+	X(pcg_engines::unique_rxs_m_xs_64_64) \
+	X(pcg_engines::unique_rxs_m_xs_128_128) \
+	X(pcg_engines::cm_unique_rxs_m_xs_128_128) \
+	X(pcg_engines::setseq_rxs_m_xs_8_8) \
+	X(pcg_engines::setseq_rxs_m_xs_16_16) \
+	X(pcg_engines::setseq_rxs_m_xs_32_32) \
+	X(pcg_engines::setseq_rxs_m_xs_64_64) \
+	X(pcg_engines::setseq_rxs_m_xs_128_128) \
+	X(pcg_engines::cm_setseq_rxs_m_xs_128_128) \
+	X(pcg_engines::oneseq_rxs_m_16_8) \
+	X(pcg_engines::oneseq_rxs_m_32_16) \
+	X(pcg_engines::oneseq_rxs_m_64_32) \
+	X(pcg_engines::oneseq_rxs_m_128_64) \
+	X(pcg_engines::cm_oneseq_rxs_m_128_64) \
+	X(pcg_engines::unique_rxs_m_16_8) \
+	X(pcg_engines::unique_rxs_m_32_16) \
+	X(pcg_engines::unique_rxs_m_64_32) \
+	X(pcg_engines::unique_rxs_m_128_64) \
+	X(pcg_engines::cm_unique_rxs_m_128_64) \
+	X(pcg_engines::setseq_rxs_m_16_8) \
+	X(pcg_engines::setseq_rxs_m_32_16) \
+	X(pcg_engines::setseq_rxs_m_64_32) \
+	X(pcg_engines::setseq_rxs_m_128_64) \
+	X(pcg_engines::cm_setseq_rxs_m_128_64) \
+	X(pcg_engines::mcg_rxs_m_16_8) \
+	X(pcg_engines::mcg_rxs_m_32_16) \
+	X(pcg_engines::mcg_rxs_m_64_32) \
+	X(pcg_engines::mcg_rxs_m_128_64) \
+	X(pcg_engines::cm_mcg_rxs_m_128_64) \
+	X(pcg_engines::oneseq_dxsm_16_8) \
+	X(pcg_engines::oneseq_dxsm_32_16) \
+	X(pcg_engines::oneseq_dxsm_64_32) \
+	X(pcg_engines::oneseq_dxsm_128_64) \
+	X(pcg_engines::cm_oneseq_dxsm_128_64) \
+	X(pcg_engines::unique_dxsm_16_8) \
+	X(pcg_engines::unique_dxsm_32_16) \
+	X(pcg_engines::unique_dxsm_64_32) \
+	X(pcg_engines::unique_dxsm_128_64) \
+	X(pcg_engines::cm_unique_dxsm_128_64) \
+	X(pcg_engines::setseq_dxsm_16_8) \
+	X(pcg_engines::setseq_dxsm_32_16) \
+	X(pcg_engines::setseq_dxsm_64_32) \
+	X(pcg_engines::setseq_dxsm_128_64) \
+	X(pcg_engines::cm_setseq_dxsm_128_64) \
+	X(pcg_engines::mcg_dxsm_16_8) \
+	X(pcg_engines::mcg_dxsm_32_16) \
+	X(pcg_engines::mcg_dxsm_64_32) \
+	X(pcg_engines::mcg_dxsm_128_64) \
+	X(pcg_engines::cm_mcg_dxsm_128_64) \
+	X(pcg_engines::oneseq_xsl_rr_64_32) \
+	X(pcg_engines::oneseq_xsl_rr_128_64) \
+	X(pcg_engines::cm_oneseq_xsl_rr_128_64) \
+	X(pcg_engines::unique_xsl_rr_64_32) \
+	X(pcg_engines::unique_xsl_rr_128_64) \
+	X(pcg_engines::cm_unique_xsl_rr_128_64) \
+	X(pcg_engines::setseq_xsl_rr_64_32) \
+	X(pcg_engines::setseq_xsl_rr_128_64) \
+	X(pcg_engines::cm_setseq_xsl_rr_128_64) \
+	X(pcg_engines::mcg_xsl_rr_64_32) \
+	X(pcg_engines::mcg_xsl_rr_128_64) \
+	X(pcg_engines::cm_mcg_xsl_rr_128_64) \
+	X(pcg_engines::oneseq_xsl_rr_rr_64_64) \
+	X(pcg_engines::oneseq_xsl_rr_rr_128_128) \
+	X(pcg_engines::cm_oneseq_xsl_rr_rr_128_128) \
+	X(pcg_engines::unique_xsl_rr_rr_64_64) \
+	X(pcg_engines::unique_xsl_rr_rr_128_128) \
+	X(pcg_engines::cm_unique_xsl_rr_rr_128_128) \
+	X(pcg_engines::setseq_xsl_rr_rr_64_64) \
+	X(pcg_engines::setseq_xsl_rr_rr_128_128) \
+	X(pcg_engines::cm_setseq_xsl_rr_rr_128_128) \
+	X(pcg32) \
+	X(pcg32_oneseq) \
+	X(pcg32_unique) \
+	X(pcg32_fast) \
+	X(pcg64) \
+	X(pcg64_oneseq) \
+	X(pcg64_unique) \
+	X(pcg64_fast) \
+	X(pcg8_once_insecure) \
+	X(pcg16_once_insecure) \
+	X(pcg32_once_insecure) \
+	X(pcg64_once_insecure) \
+	X(pcg128_once_insecure) \
+	X(pcg8_oneseq_once_insecure) \
+	X(pcg16_oneseq_once_insecure) \
+	X(pcg32_oneseq_once_insecure) \
+	X(pcg64_oneseq_once_insecure) \
+	X(pcg128_oneseq_once_insecure) \
+	X(pcg32_k2) \
+	X(pcg32_k2_fast) \
+	X(pcg32_k64) \
+	X(pcg32_k64_oneseq) \
+	X(pcg32_k64_fast) \
+	X(pcg32_c64) \
+	X(pcg32_c64_oneseq) \
+	X(pcg32_c64_fast) \
+	X(pcg64_k32) \
+	X(pcg64_k32_oneseq) \
+	X(pcg64_k32_fast) \
+	X(pcg64_c32) \
+	X(pcg64_c32_oneseq) \
+	X(pcg64_c32_fast) \
+	X(pcg32_k1024) \
+	X(pcg32_k1024_fast) \
+	X(pcg32_c1024) \
+	X(pcg32_c1024_fast) \
+	X(pcg64_k1024) \
+	X(pcg64_k1024_fast) \
+	X(pcg64_c1024) \
+	X(pcg64_c1024_fast) \
+	X(pcg32_k16384) \
+	X(pcg32_k16384_fast)
+
+namespace
+{
+	constexpr std::size_t Batch = 1024;
+
+	//opaque zero, so the compiler can't see that the latency chain always picks the same engine
+	volatile std::size_t zeroMask = 0;
+
+	template<typename E, typename = void>
+	struct HasAdvance : std::false_type {};
+
+	template<typename E>
+	struct HasAdvance<E, std::void_t<decltype(std::declval<E&>().advance(typename E::state_type()))>> : std::true_type {};
+
+	//the _c extended engines declare advance but reject it at compile time
+	template<pcg_extras::bitcount_t Table, pcg_extras::bitcount_t Advance, typename Base_t, typename Ext_t>
+	struct HasAdvance<pcg_detail::extended<Table, Advance, Base_t, Ext_t, false>> : std::false_type {};
+
+	struct EngineResult
+	{
+		std::string name;
+		std::size_t stateBytes;
+		std::size_t resultBits;
+		double throughputNs = -1;
+		double gbPerSec = -1;
+		double latencyNs = -1;
+		double advanceNs = -1;
+	};
+
+	template<typename Engine_t>
+	void Measure(Bench::Runner& runner, std::vector<EngineResult>& results, const std::string& name)
+	{
+		using Result_t = typename Engine_t::result_type;
+
+		EngineResult result;
+		result.name = name;
+		result.stateBytes = sizeof(Engine_t);
+		result.resultBits = sizeof(Result_t) * 8;
+
+		//two copies so the latency chain can select one through the previous output
+		std::unique_ptr<Engine_t[]> engines(new Engine_t[2]);
+		Engine_t& engine = engines[0];
+
+		//independent calls, limited only by the state update
+		if (const Bench::Result* r = runner.Run(name + " throughput", Batch, sizeof(Result_t), [&] {
+			Result_t acc = 0;
+			for (std::size_t i = 0; i < Batch; i++) {
+				acc ^= engine();
+			}
+			Bench::DoNotOptimize(acc);
+		})) {
+			result.throughputNs = r->nsPerItem;
+			result.gbPerSec = r->gbPerSec;
+		}
+
+		//each call's engine address depends on the previous output, so calls can't overlap
+		if (const Bench::Result* r = runner.Run(name + " latency", Batch, sizeof(Result_t), [&] {
+			const std::size_t mask = zeroMask;
+			Result_t x = 0;
+			for (std::size_t i = 0; i < Batch; i++) {
+				x = engines[static_cast<std::size_t>(x) & mask]();
+			}
+			Bench::DoNotOptimize(x);
+		})) {
+			result.latencyNs = r->nsPerItem;
+		}
+
+		if constexpr (HasAdvance<Engine_t>::value) {
+			using State_t = typename Engine_t::state_type;
+			std::uint64_t delta = 0x9E3779B97F4A7C15ull;
+			if (const Bench::Result* r = runner.Run(name + " advance", 1, 0, [&] {
+				engine.advance(static_cast<State_t>(delta));
+				delta += 0x2545F4914F6CDD1Dull;
+				Bench::DoNotOptimize(engine);
+			})) {
+				result.advanceNs = r->nsPerItem;
+			}
+		}
+
+		results.push_back(result);
+	}
+
+	void Number(std::FILE* file, const char* key, double value, const char* separator)
+	{
+		if (value < 0) {
+			std::fprintf(file, "\"%s\": null%s", key, separator);
+		} else {
+			std::fprintf(file, "\"%s\": %.6g%s", key, value, separator);
+		}
+	}
+
+	bool WriteJson(const std::string& path, const std::vector<EngineResult>& results)
+	{
+		std::FILE* file = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+		if (!file) {
+			std::perror(path.c_str());
+			return false;
+		}
+		std::fprintf(file, "{\n");
+		for (std::size_t i = 0; i < results.size(); i++) {
+			const EngineResult& r = results[i];
+			std::fprintf(file, "  \"%s\": { \"state_bytes\": %zu, \"result_bits\": %zu, ", r.name.c_str(), r.stateBytes, r.resultBits);
+			Number(file, "throughput_ns", r.throughputNs, ", ");
+			Number(file, "gb_per_s", r.gbPerSec, ", ");
+			Number(file, "latency_ns", r.latencyNs, ", ");
+			Number(file, "advance_ns", r.advanceNs, "");
+			std::fprintf(file, " }%s\n", i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(file, "}\n");
+		if (file != stdout) {
+			std::fclose(file);
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Bench::Options options = Bench::Options::Parse(argc, argv);
+	if (options.json.empty()) {
+		options.json = "pcg_engines.json";
+	}
+	const std::string json = options.json;
+	options.json.clear();
+	Bench::Runner runner(options);
+	std::vector<EngineResult> results;
+
+#define RANDOM_BENCH_MEASURE(Engine_t) Measure<Engine_t>(runner, results, #Engine_t);
+	RANDOM_BENCH_PCG_ENGINES(RANDOM_BENCH_MEASURE)
+#undef RANDOM_BENCH_MEASURE
+
+	//engines from Random.hpp and the standard library, for reference
+	Measure<Random::Philox>(runner, results, "Random::Philox");
+	Measure<std::mt19937>(runner, results, "std::mt19937");
+	Measure<std::mt19937_64>(runner, results, "std::mt19937_64");
+
+	return WriteJson(json, results) ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+///Performance regression check for the hot paths of Random, run by CTest.
+///Each benchmark is timed relative to a raw pcg32 calibration kernel, so the checked-in
+///baseline carries over between machines, and compared against baseline.json.
+#include "Random.hpp"
+#include "Harness.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr std::size_t Batch = 1024;
+
+	struct Case
+	{
+		std::string name;
+		std::size_t items;
+		std::function<void()> fn;
+	};
+
+	struct Ratio
+	{
+		double ratio;
+		double mad;
+	};
+
+	template<typename Fn>
+	Case Scalar(const std::string& name, Fn fn)
+	{
+		return { name, Batch, [fn] {
+			for (std::size_t i = 0; i < Batch; i++) {
+				Bench::DoNotOptimize(fn());
+			}
+		} };
+	}
+
+	std::vector<Case> Cases()
+	{
+		std::vector<Case> cases;
+		cases.push_back(Scalar("GetInt<int>", [] { return Random::GetInt(1, 6); }));
+		cases.push_back(Scalar("GetInt<uint64_t>", [] { return Random::GetInt<std::uint64_t>(0, 1000000007); }));
+		cases.push_back(Scalar("GetByte", [] { return Random::GetByte(); }));
+		cases.push_back(Scalar("GetFloat<double>", [] { return Random::GetFloat(0.0, 1.0); }));
+		cases.push_back(Scalar("GetFloatNormal<double>", [] { return Random::GetFloatNormal(0.0, 1.0); }));
+		cases.push_back(Scalar("Chance(double)", [] { return Random::Chance(0.3); }));
+		cases.push_back({ "GetString AlphaNum len=64", 64, [] {
+			Bench::DoNotOptimize(Random::GetString(Random::Charset::AlphaNum, 64));
+		} });
+		for (std::size_t n : { std::size_t(4096), std::size_t(65536) }) {
+			auto values = std::make_shared<std::vector<int>>(n);
+			std::iota(values->begin(), values->end(), 0);
+			cases.push_back({ "Shuffle n=" + std::to_string(n), n, [values] {
+				Random::Shuffle(*values);
+				Bench::DoNotOptimize(values->data());
+			} });
+		}
+		auto bytes = std::make_shared<std::vector<unsigned char>>(65536);
+		cases.push_back({ "FillBytes 64 KiB", bytes->size() / 4, [bytes] {
+			Random::FillBytes(bytes->data(), bytes->size());
+			Bench::DoNotOptimize(bytes->data());
+		} });
+		auto stream = std::make_shared<Random::Stream>(42, 1);
+		cases.push_back(Scalar("Stream GetInt<int>", [stream] { return stream->GetInt(1, 6); }));
+		return cases;
+	}
+
+	/// <summary>
+	/// Times one case and the calibration kernel back to back and returns their ratio.
+	/// </summary>
+	Ratio Measure(Bench::Options options, const Case& c)
+	{
+		//cases are already filtered, and the calibration must always run
+		options.filter.clear();
+		Bench::Runner runner(options);
+		pcg32 engine(42, 54);
+		const Bench::Result calibration = *runner.Run("calibration (raw pcg32)", Batch, 4, [&] {
+			std::uint32_t acc = 0;
+			for (std::size_t i = 0; i < Batch; i++) {
+				acc ^= engine();
+			}
+			Bench::DoNotOptimize(acc);
+		});
+		const Bench::Result result = *runner.Run(c.name, c.items, 0, c.fn);
+		return { result.nsPerItem / calibration.nsPerItem, result.madNs / calibration.nsPerItem };
+	}
+
+	using Entries = std::vector<std::pair<std::string, Ratio>>;
+
+	Entries::iterator Find(Entries& entries, const std::string& name)
+	{
+		return std::find_if(entries.begin(), entries.end(), [&](const auto& entry) { return entry.first == name; });
+	}
+
+	/// <summary>
+	/// Reads the one-entry-per-line format written by WriteBaseline, in file order.
+	/// </summary>
+	Entries ReadBaseline(const std::string& path)
+	{
+		Entries baseline;
+		std::ifstream file(path);
+		std::string line;
+		while (std::getline(file, line)) {
+			const std::size_t open = line.find('"');
+			const std::size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+			const std::size_t ratio = line.find("\"ratio\":");
+			const std::size_t mad = line.find("\"mad\":");
+			if (close == std::string::npos || ratio == std::string::npos || mad == std::string::npos) {
+				continue;
+			}
+			baseline.emplace_back(line.substr(open + 1, close - open - 1), Ratio{
+				std::strtod(line.c_str() + ratio + 8, nullptr),
+				std::strtod(line.c_str() + mad + 6, nullptr)
+			});
+		}
+		return baseline;
+	}
+
+	/// <summary>
+	/// Updates the measured entries of the baseline and keeps the ones filtered out where they are.
+	/// New cases go at the end.
+	/// </summary>
+	bool WriteBaseline(const std::string& path, const Entries& measured)
+	{
+		Entries ratios = ReadBaseline(path);
+		for (const auto& entry : measured) {
+			const auto it = Find(ratios, entry.first);
+			if (it != ratios.end()) {
+				it->second = entry.second;
+			} else {
+				ratios.push_back(entry);
+			}
+		}
+
+		std::ofstream file(path);
+		if (!file) {
+			return false;
+		}
+		file << "{\n";
+		for (std::size_t i = 0; i < ratios.size(); i++) {
+			char line[256];
+			std::snprintf(line, sizeof(line), "  \"%s\": { \"ratio\": %.4f, \"mad\": %.4f }%s\n",
+				ratios[i].first.c_str(), ratios[i].second.ratio, ratios[i].second.mad, i + 1 < ratios.size() ? "," : "");
+			file << line;
+		}
+		file << "}\n";
+		return static_cast<bool>(file);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> rest;
+	Bench::Options options = Bench::Options::Parse(argc, argv, &rest);
+	options.repetitions = std::max<std::size_t>(options.repetitions, 7);
+	options.minTimeMs = std::min(options.minTimeMs, 10.0);
+
+	std::string baselinePath = "baseline.json";
+	double tolerance = 0.5;
+	bool update = false;
+	for (std::size_t i = 0; i < rest.size(); i++) {
+		if (rest[i] == "--baseline" && i + 1 < rest.size()) {
+			baselinePath = rest[++i];
+		} else if (rest[i] == "--tolerance" && i + 1 < rest.size()) {
+			tolerance = std::strtod(rest[++i].c_str(), nullptr);
+		} else if (rest[i] == "--update") {
+			update = true;
+		} else {
+			std::fprintf(stderr, "usage: %s [--baseline file] [--tolerance fraction] [--update] [--filter text] [--reps n]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	Random::Seed(42u);
+	Entries baseline = update ? Entries() : ReadBaseline(baselinePath);
+	if (!update && baseline.empty()) {
+		std::fprintf(stderr, "could not read baseline %s\n", baselinePath.c_str());
+		return 1;
+	}
+
+	Entries ratios;
+	int failures = 0;
+	for (const Case& c : Cases()) {
+		if (!options.filter.empty() && c.name.find(options.filter) == std::string::npos) {
+			continue;
+		}
+		Ratio ratio = Measure(options, c);
+		if (update) {
+			ratios.emplace_back(c.name, ratio);
+			continue;
+		}
+
+		const auto expected = Find(baseline, c.name);
+		if (expected == baseline.end()) {
+			std::printf("  %s has no baseline, skipped\n", c.name.c_str());
+			continue;
+		}
+		//generous limit: tolerance on top of the baseline, plus three MADs of noise from both runs
+		const Ratio& base = expected->second;
+		const auto limit = [&](const Ratio& r) { return base.ratio * (1.0 + tolerance) + 3.0 * (base.mad + r.mad); };
+		//a single slow run is usually noise, so re-measure before failing
+		for (int retry = 0; retry < 2 && ratio.ratio > limit(ratio); retry++) {
+			const Ratio again = Measure(options, c);
+			if (again.ratio < ratio.ratio) {
+				ratio = again;
+			}
+		}
+		const bool ok = ratio.ratio <= limit(ratio);
+		std::printf("%s %-32s ratio %.3f baseline %.3f limit %.3f\n",
+			ok ? "  ok  " : "  FAIL", c.name.c_str(), ratio.ratio, base.ratio, limit(ratio));
+		failures += ok ? 0 : 1;
+	}
+
+	if (update) {
+		if (!WriteBaseline(baselinePath, ratios)) {
+			std::fprintf(stderr, "could not write baseline %s\n", baselinePath.c_str());
+			return 1;
+		}
+		std::printf("wrote %s\n", baselinePath.c_str());
+		return 0;
+	}
+	if (failures) {
+		std::printf("%d benchmark(s) regressed\n", failures);
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+///Known-answer test for Random::Philox, run by CTest.
+///Checks the philox4x32-10 rows of Random123's kat_vectors: the zero, all-ones and pi
+///counter/key cases. A statistical battery can't tell a wrong round constant or key schedule
+///from a correct one, since both produce good-looking output.
+#include "Random.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+namespace
+{
+	struct Vector
+	{
+		const char* name;
+		std::uint32_t counter[4];
+		std::uint32_t key[2];
+		std::uint32_t expected[4];
+	};
+
+	const Vector Vectors[] = {
+		{ "zero", { 0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u }, { 0x00000000u, 0x00000000u },
+			{ 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u } },
+		{ "all ones", { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu }, { 0xffffffffu, 0xffffffffu },
+			{ 0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu } },
+		{ "pi", { 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u }, { 0xa4093822u, 0x299f31d0u },
+			{ 0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u } },
+	};
+
+	std::uint64_t Join(std::uint32_t low, std::uint32_t high)
+	{
+		return (static_cast<std::uint64_t>(high) << 32) | low;
+	}
+}
+
+int main()
+{
+	int failures = 0;
+	for (const Vector& v : Vectors) {
+		//counter words 0-1 are the block index and 2-3 the stream, key words 0-1 the key
+		const std::uint64_t key = Join(v.key[0], v.key[1]);
+		const std::uint64_t stream = Join(v.counter[2], v.counter[3]);
+		const std::uint64_t block = Join(v.counter[0], v.counter[1]);
+
+		std::uint32_t fromBlock[4];
+		Random::Philox::Block(key, stream, block, fromBlock);
+		bool ok = true;
+		for (int i = 0; i < 4; i++) {
+			ok = ok && fromBlock[i] == v.expected[i];
+		}
+
+		//values are indexed with 64 bits, so only the first 2^62 blocks of a stream can be reached
+		//through the engine, At and Fill
+		if (block < (std::uint64_t(1) << 62)) {
+			std::uint32_t fromFill[4];
+			Random::Philox::Fill(key, stream, block * 4, fromFill, 4);
+			Random::Philox engine(key, stream, block * 4);
+			for (int i = 0; i < 4; i++) {
+				const std::uint32_t fromEngine = engine();
+				ok = ok && fromFill[i] == v.expected[i] && fromEngine == v.expected[i]
+					&& Random::Philox::At(key, stream, block * 4 + i) == v.expected[i];
+			}
+		}
+		std::printf("%s philox4x32-10 %-8s %08x %08x %08x %08x\n", ok ? "  ok  " : "  FAIL", v.name,
+			fromBlock[0], fromBlock[1], fromBlock[2], fromBlock[3]);
+		failures += ok ? 0 : 1;
+	}
+	std::printf("%d failure(s)\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,871 @@
+///Statistical quality tests for Random, run by CTest.
+///Values are drawn in parallel from Random::Stream instances (and single-threaded through the global API),
+///then checked with chi-square, Kolmogorov-Smirnov, birthday spacings, gap and permutation tests.
+///The samplers are checked against their reference distributions, and the low-discrepancy sequences
+///for stratification.
+///The seed is fixed, so a run is deterministic. Use --scale to stream more values.
+#include "Random.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using Counts = std::vector<std::uint64_t>;
+
+	struct Options
+	{
+		double scale = 1.0;
+		unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+		std::uint64_t seed = 0x5EED;
+		double alpha = 1e-6;
+	};
+
+	Options options;
+	int failures = 0;
+	std::uint64_t nextStream = 0;
+
+	//-------------------------------------------------------------------------------------------------
+	// distributions
+
+	/// <summary>
+	/// Regularized upper incomplete gamma function Q(a, x).
+	/// </summary>
+	double GammaQ(double a, double x)
+	{
+		if (x <= 0) {
+			return 1.0;
+		}
+		const double logPrefix = -x + a * std::log(x) - std::lgamma(a);
+		if (x < a + 1) {
+			double term = 1.0 / a;
+			double sum = term;
+			for (int n = 1; n < 10000; n++) {
+				term *= x / (a + n);
+				sum += term;
+				if (std::fabs(term) < std::fabs(sum) * 1e-15) {
+					break;
+				}
+			}
+			return std::max(0.0, 1.0 - sum * std::exp(logPrefix));
+		}
+		//continued fraction, modified Lentz
+		const double tiny = 1e-300;
+		double b = x + 1 - a;
+		double c = 1 / tiny;
+		double d = 1 / b;
+		double h = d;
+		for (int i = 1; i < 10000; i++) {
+			const double an = -i * (i - a);
+			b += 2;
+			d = an * d + b;
+			d = std::fabs(d) < tiny ? tiny : d;
+			c = b + an / c;
+			c = std::fabs(c) < tiny ? tiny : c;
+			d = 1 / d;
+			const double delta = d * c;
+			h *= delta;
+			if (std::fabs(delta - 1) < 1e-15) {
+				break;
+			}
+		}
+		return std::exp(logPrefix) * h;
+	}
+
+	double ChiSquareP(double statistic, double dof)
+	{
+		return GammaQ(dof / 2, statistic / 2);
+	}
+
+	/// <summary>
+	/// P(D > d) for the one-sample Kolmogorov-Smirnov statistic of n values.
+	/// </summary>
+	double KolmogorovP(double d, double n)
+	{
+		const double sqrtN = std::sqrt(n);
+		const double lambda = (sqrtN + 0.12 + 0.11 / sqrtN) * d;
+		if (lambda < 0.2) {
+			return 1.0;
+		}
+		double sum = 0;
+		double sign = 1;
+		for (int j = 1; j < 100; j++) {
+			const double term = sign * std::exp(-2.0 * j * j * lambda * lambda);
+			sum += term;
+			if (std::fabs(term) < 1e-16) {
+				break;
+			}
+			sign = -sign;
+		}
+		return std::min(1.0, std::max(0.0, 2 * sum));
+	}
+
+	double NormalCdf(double x)
+	{
+		return 0.5 * std::erfc(-x / std::sqrt(2.0));
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// reporting
+
+	/// <summary>
+	/// Records a p-value. Both tails fail, since a fit that is too good is as suspicious as a bad one.
+	/// </summary>
+	void Report(const std::string& name, double statistic, double p)
+	{
+		const bool ok = p >= options.alpha && p <= 1 - options.alpha;
+		std::printf("%s %-52s stat %14.4f  p %.6f\n", ok ? "  ok  " : "  FAIL", name.c_str(), statistic, p);
+		std::fflush(stdout);
+		failures += ok ? 0 : 1;
+	}
+
+	/// <summary>
+	/// Records a check that holds exactly rather than with some probability.
+	/// </summary>
+	void Expect(const std::string& name, double statistic, bool ok)
+	{
+		std::printf("%s %-52s stat %14.4f  exact\n", ok ? "  ok  " : "  FAIL", name.c_str(), statistic);
+		std::fflush(stdout);
+		failures += ok ? 0 : 1;
+	}
+
+	void ChiSquare(const std::string& name, const Counts& counts, const std::vector<double>& probabilities, double dof)
+	{
+		std::uint64_t total = 0;
+		for (std::uint64_t c : counts) {
+			total += c;
+		}
+		double statistic = 0;
+		for (std::size_t i = 0; i < counts.size(); i++) {
+			const double expected = probabilities[i] * total;
+			const double diff = counts[i] - expected;
+			statistic += diff * diff / expected;
+		}
+		Report(name, statistic, ChiSquareP(statistic, dof));
+	}
+
+	void ChiSquareUniform(const std::string& name, const Counts& counts)
+	{
+		ChiSquare(name, counts, std::vector<double>(counts.size(), 1.0 / counts.size()), counts.size() - 1.0);
+	}
+
+	/// <summary>
+	/// Chi-square test against a discrete distribution. Neighbouring cells are pooled until each
+	/// expects at least 20 values, so long tails don't need to be cut off by hand.
+	/// </summary>
+	void ChiSquarePooled(const std::string& name, const Counts& counts, const std::vector<double>& probabilities)
+	{
+		std::uint64_t total = 0;
+		for (std::uint64_t c : counts) {
+			total += c;
+		}
+		Counts pooled;
+		std::vector<double> pooledProbabilities;
+		std::uint64_t count = 0;
+		double probability = 0;
+		for (std::size_t i = 0; i < counts.size(); i++) {
+			count += counts[i];
+			probability += probabilities[i];
+			if (probability * total >= 20) {
+				pooled.push_back(count);
+				pooledProbabilities.push_back(probability);
+				count = 0;
+				probability = 0;
+			}
+		}
+		if (pooled.empty()) {
+			pooled.push_back(0);
+			pooledProbabilities.push_back(0);
+		}
+		pooled.back() += count;
+		pooledProbabilities.back() += probability;
+		ChiSquare(name, pooled, pooledProbabilities, pooled.size() - 1.0);
+	}
+
+	/// <summary>
+	/// Kolmogorov-Smirnov statistic of values that should be uniform on [0, 1).
+	/// </summary>
+	double KolmogorovD(std::vector<double>& values)
+	{
+		std::sort(values.begin(), values.end());
+		const double n = static_cast<double>(values.size());
+		double d = 0;
+		for (std::size_t i = 0; i < values.size(); i++) {
+			d = std::max(d, std::max((i + 1) / n - values[i], values[i] - i / n));
+		}
+		return d;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// parallel driver
+
+	std::uint64_t Scaled(double count)
+	{
+		return std::max<std::uint64_t>(1, static_cast<std::uint64_t>(count * options.scale));
+	}
+
+	/// <summary>
+	/// Splits count draws over the worker threads. Each chunk gets its own Stream and its own
+	/// result, which are merged in chunk order, so the outcome does not depend on the thread count.
+	/// </summary>
+	template<typename Result_t, typename Fn, typename Merge_t>
+	Result_t Parallel(std::uint64_t count, std::uint64_t chunks, Result_t initial, Fn fn, Merge_t merge)
+	{
+		const std::uint64_t base = nextStream;
+		nextStream += chunks;
+		std::vector<Result_t> results(chunks, initial);
+		std::vector<std::thread> workers;
+		std::atomic<std::uint64_t> next{ 0 };
+		for (unsigned t = 0; t < options.threads; t++) {
+			workers.emplace_back([&] {
+				for (std::uint64_t chunk; (chunk = next++) < chunks;) {
+					Random::Stream stream(options.seed, base + chunk);
+					const std::uint64_t begin = count * chunk / chunks;
+					const std::uint64_t end = count * (chunk + 1) / chunks;
+					fn(stream, end - begin, results[chunk]);
+				}
+			});
+		}
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		Result_t result = initial;
+		for (const Result_t& r : results) {
+			merge(result, r);
+		}
+		return result;
+	}
+
+	template<typename Fn>
+	Counts ParallelCounts(std::uint64_t count, std::size_t cells, Fn fn)
+	{
+		return Parallel(count, 64, Counts(cells), fn, [](Counts& total, const Counts& part) {
+			for (std::size_t i = 0; i < total.size(); i++) {
+				total[i] += part[i];
+			}
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// tests
+
+	template<typename Int_t>
+	void BoundedInts(Int_t range)
+	{
+		const Counts counts = ParallelCounts(Scaled(2e6), static_cast<std::size_t>(range), [range](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			for (std::uint64_t i = 0; i < n; i++) {
+				c[static_cast<std::size_t>(stream.GetInt<Int_t>(0, range - 1))]++;
+			}
+		});
+		ChiSquareUniform("chi-square GetInt [0, " + std::to_string(range) + ")", counts);
+	}
+
+	void WideInts()
+	{
+		//a range that isn't a power of two, bucketed by value
+		const std::uint64_t range = 0xBFFFFFFFFFFFFFFFull;
+		const std::size_t cells = 1000;
+		const Counts counts = ParallelCounts(Scaled(4e6), cells, [=](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			for (std::uint64_t i = 0; i < n; i++) {
+				const std::uint64_t v = stream.GetInt<std::uint64_t>(0, range);
+				c[std::min<std::size_t>(cells - 1, static_cast<std::size_t>(static_cast<long double>(v) / (static_cast<long double>(range) + 1) * cells))]++;
+			}
+		});
+		ChiSquareUniform("chi-square GetInt<uint64_t> [0, 3*2^62) 1000 cells", counts);
+	}
+
+	void Bytes()
+	{
+		const Counts counts = ParallelCounts(Scaled(4e6), 256, [](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			for (std::uint64_t i = 0; i < n; i++) {
+				c[stream.GetByte()]++;
+			}
+		});
+		ChiSquareUniform("chi-square GetByte", counts);
+
+		//adjacent pairs also catch correlation between the lanes that FillBytes interleaves
+		const Counts pairs = ParallelCounts(Scaled(3.2e7), 65536, [](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			std::vector<unsigned char> bytes(4096);
+			for (std::uint64_t i = 0; i < n; i += bytes.size() / 2) {
+				stream.FillBytes(bytes.data(), bytes.size());
+				for (std::size_t j = 0; j + 1 < bytes.size() && i + j / 2 < n; j += 2) {
+					c[bytes[j] * 256u + bytes[j + 1]]++;
+				}
+			}
+		});
+		ChiSquareUniform("chi-square FillBytes pairs", pairs);
+	}
+
+	void Chance()
+	{
+		const Counts counts = ParallelCounts(Scaled(4e6), 2, [](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			for (std::uint64_t i = 0; i < n; i++) {
+				c[stream.Chance(0.3) ? 1 : 0]++;
+			}
+		});
+		ChiSquare("chi-square Chance(0.3)", counts, { 0.7, 0.3 }, 1);
+	}
+
+	template<typename Float_t>
+	void FloatBins(const char* type)
+	{
+		const std::size_t cells = 1024;
+		const Counts counts = ParallelCounts(Scaled(4e6), cells, [=](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			for (std::uint64_t i = 0; i < n; i++) {
+				const Float_t u = stream.GetFloat<Float_t>(0, 1);
+				c[std::min<std::size_t>(cells - 1, static_cast<std::size_t>(u * cells))]++;
+			}
+		});
+		ChiSquareUniform(std::string("chi-square GetFloat<") + type + "> 1024 cells", counts);
+	}
+
+	/// <summary>
+	/// KS test per chunk, then a second-level KS test on the chunk p-values.
+	/// toUniform maps a draw to [0, 1) through the target distribution's CDF.
+	/// </summary>
+	void Kolmogorov(const std::string& name, std::function<double(Random::Stream&)> toUniform, double count = 4e6)
+	{
+		const std::uint64_t chunks = 32;
+		const std::vector<double> pValues = Parallel(Scaled(count), chunks, std::vector<double>(),
+			[&](Random::Stream& stream, std::uint64_t n, std::vector<double>& p) {
+				std::vector<double> values(n);
+				for (double& v : values) {
+					v = toUniform(stream);
+				}
+				p.push_back(KolmogorovP(KolmogorovD(values), static_cast<double>(n)));
+			},
+			[](std::vector<double>& all, const std::vector<double>& part) { all.insert(all.end(), part.begin(), part.end()); });
+		std::vector<double> sorted = pValues;
+		const double d = KolmogorovD(sorted);
+		Report(name, d, KolmogorovP(d, static_cast<double>(pValues.size())));
+	}
+
+	/// <summary>
+	/// Marsaglia's birthday spacings test on the full 32-bit output of GetInt<uint32_t>.
+	/// The number of repeated spacings among m birthdays in 2^32 days is Poisson with mean m^3/2^34.
+	/// </summary>
+	void BirthdaySpacings()
+	{
+		const std::size_t m = 4096;
+		const double lambda = std::pow(static_cast<double>(m), 3) / std::pow(2.0, 34);
+		const std::uint64_t repetitions = Scaled(2000);
+		const Counts duplicates = ParallelCounts(repetitions, 1, [=](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			std::vector<std::uint32_t> days(m);
+			for (std::uint64_t r = 0; r < n; r++) {
+				for (std::uint32_t& day : days) {
+					day = stream.GetInt<std::uint32_t>(0, 0xFFFFFFFFu);
+				}
+				std::sort(days.begin(), days.end());
+				for (std::size_t i = m - 1; i > 0; i--) {
+					days[i] -= days[i - 1];
+				}
+				std::sort(days.begin() + 1, days.end());
+				for (std::size_t i = 2; i < m; i++) {
+					c[0] += days[i] == days[i - 1];
+				}
+			}
+		});
+		//two-sided Poisson tail for the total number of repeats
+		const double mean = lambda * repetitions;
+		const double k = static_cast<double>(duplicates[0]);
+		const double lower = GammaQ(k + 1, mean);
+		const double upper = k > 0 ? 1 - GammaQ(k, mean) : 1.0;
+		Report("birthday spacings GetInt<uint32_t> m=4096", k / repetitions, std::min(1.0, 2 * std::min(lower, upper)));
+	}
+
+	/// <summary>
+	/// Knuth's gap test: lengths of runs between floats landing in [0.375, 0.625).
+	/// </summary>
+	void Gaps()
+	{
+		const std::size_t t = 24;
+		const double p = 0.25;
+		const Counts counts = ParallelCounts(Scaled(4e6), t + 1, [=](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			std::size_t gap = 0;
+			for (std::uint64_t i = 0; i < n; i++) {
+				const double u = stream.GetFloat(0.0, 1.0);
+				if (u >= 0.375 && u < 0.625) {
+					c[std::min(gap, t)]++;
+					gap = 0;
+				} else {
+					gap++;
+				}
+			}
+		});
+		std::vector<double> probabilities(t + 1);
+		for (std::size_t r = 0; r < t; r++) {
+			probabilities[r] = p * std::pow(1 - p, static_cast<double>(r));
+		}
+		probabilities[t] = std::pow(1 - p, static_cast<double>(t));
+		ChiSquare("gap test GetFloat<double> [0.375, 0.625)", counts, probabilities, static_cast<double>(t));
+	}
+
+	/// <summary>
+	/// Index of a permutation of 0..n-1 in factorial base.
+	/// </summary>
+	template<std::size_t N>
+	std::size_t Lehmer(const std::array<int, N>& perm)
+	{
+		std::size_t index = 0;
+		for (std::size_t i = 0; i < N; i++) {
+			std::size_t smaller = 0;
+			for (std::size_t j = i + 1; j < N; j++) {
+				smaller += perm[j] < perm[i];
+			}
+			index = index * (N - i) + smaller;
+		}
+		return index;
+	}
+
+	void Permutations()
+	{
+		const Counts counts = ParallelCounts(Scaled(2e6), 120, [](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			std::array<int, 5> values = { 0, 1, 2, 3, 4 };
+			for (std::uint64_t i = 0; i < n; i++) {
+				stream.Shuffle(values);
+				c[Lehmer(values)]++;
+			}
+		});
+		ChiSquareUniform("permutations Shuffle n=5 (120 cells)", counts);
+
+		//where each element of a 16 element array ends up
+		const std::size_t n = 16;
+		const Counts positions = ParallelCounts(Scaled(5e5), n * n, [=](Random::Stream& stream, std::uint64_t count, Counts& c) {
+			std::vector<int> values(n);
+			for (std::uint64_t i = 0; i < count; i++) {
+				for (std::size_t j = 0; j < n; j++) {
+					values[j] = static_cast<int>(j);
+				}
+				stream.Shuffle(values);
+				for (std::size_t j = 0; j < n; j++) {
+					c[values[j] * n + j]++;
+				}
+			}
+		});
+		ChiSquare("positions Shuffle n=16", positions, std::vector<double>(n * n, 1.0 / (n * n)), (n - 1.0) * (n - 1.0));
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// samplers
+
+	/// <summary>
+	/// Chi-square test of an integer sampler against its probability mass function. The last of the
+	/// cells also collects every larger value.
+	/// </summary>
+	template<typename Sampler_t>
+	void Discrete(const std::string& name, const Sampler_t& sampler, std::size_t cells, std::function<double(double)> pmf)
+	{
+		const Counts counts = ParallelCounts(Scaled(2e6), cells, [&](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			for (std::uint64_t i = 0; i < n; i++) {
+				c[std::min<std::size_t>(cells - 1, static_cast<std::size_t>(sampler(stream)))]++;
+			}
+		});
+		std::vector<double> probabilities(cells);
+		double rest = 1;
+		for (std::size_t k = 0; k + 1 < cells; k++) {
+			probabilities[k] = pmf(static_cast<double>(k));
+			rest -= probabilities[k];
+		}
+		probabilities[cells - 1] = std::max(0.0, rest);
+		ChiSquarePooled(name, counts, probabilities);
+	}
+
+	double PoissonPmf(double mean, double k)
+	{
+		return std::exp(k * std::log(mean) - mean - std::lgamma(k + 1));
+	}
+
+	double BinomialPmf(double t, double p, double k)
+	{
+		return std::exp(std::lgamma(t + 1) - std::lgamma(k + 1) - std::lgamma(t - k + 1) + k * std::log(p) + (t - k) * std::log1p(-p));
+	}
+
+	void Samplers()
+	{
+		//Poisson: multiplication below a mean of 10, PTRS above
+		Discrete("chi-square Poisson(4)", Random::Poisson<int>(4.0), 40, [](double k) { return PoissonPmf(4.0, k); });
+		Discrete("chi-square Poisson(50) PTRS", Random::Poisson<int>(50.0), 150, [](double k) { return PoissonPmf(50.0, k); });
+		Discrete("chi-square Poisson(1e4) PTRS", Random::Poisson<int>(1e4), 11000, [](double k) { return PoissonPmf(1e4, k); });
+
+		//Binomial: inversion while (t + 1) * min(p, 1 - p) < 11, BTRD above, mirrored for p > 0.5
+		Discrete("chi-square Binomial(20, 0.3) inversion", Random::Binomial<int>(20, 0.3), 21, [](double k) { return BinomialPmf(20, 0.3, k); });
+		Discrete("chi-square Binomial(1000, 0.3) BTRD", Random::Binomial<int>(1000, 0.3), 1001, [](double k) { return BinomialPmf(1000, 0.3, k); });
+		Discrete("chi-square Binomial(1000, 0.85) BTRD", Random::Binomial<int>(1000, 0.85), 1001, [](double k) { return BinomialPmf(1000, 0.85, k); });
+
+		Discrete("chi-square Geometric(0.2)", Random::Geometric<int>(0.2), 100, [](double k) { return 0.2 * std::pow(0.8, k); });
+		Discrete("chi-square Geometric(0.001)", Random::Geometric<int>(0.001), 20000, [](double k) { return 0.001 * std::pow(0.999, k); });
+
+		//alias method, with a table size that isn't a power of two
+		const std::vector<double> weights = { 1, 2, 3, 4, 5, 6, 7 };
+		Discrete("chi-square Categorical 7 weights", Random::Categorical<int>(weights.begin(), weights.end()), weights.size(),
+			[](double k) { return (k + 1) / 28; });
+
+		//Multinomial draws a chain of conditional binomials, but each bucket on its own is Binomial(n, p)
+		const std::size_t trials = 100;
+		const std::vector<double> shares = { 0.1, 0.2, 0.3, 0.4 };
+		const Random::Multinomial multinomial(shares.begin(), shares.end());
+		const Counts marginals = ParallelCounts(Scaled(5e5), shares.size() * (trials + 1) + 1, [&](Random::Stream& stream, std::uint64_t n, Counts& c) {
+			std::vector<std::uint64_t> out(shares.size());
+			for (std::uint64_t i = 0; i < n; i++) {
+				multinomial.Counts(stream, trials, out.begin());
+				std::uint64_t sum = 0;
+				for (std::size_t b = 0; b < out.size(); b++) {
+					c[b * (trials + 1) + out[b]]++;
+					sum += out[b];
+				}
+				c.back() += sum != trials;
+			}
+		});
+		Expect("Multinomial counts sum to n", static_cast<double>(marginals.back()), marginals.back() == 0);
+		for (std::size_t b = 0; b < shares.size(); b++) {
+			std::vector<double> probabilities(trials + 1);
+			for (std::size_t k = 0; k <= trials; k++) {
+				probabilities[k] = BinomialPmf(static_cast<double>(trials), shares[b], static_cast<double>(k));
+			}
+			ChiSquarePooled("chi-square Multinomial bucket " + std::to_string(b) + " (p " + std::to_string(shares[b]).substr(0, 3) + ")",
+				Counts(marginals.begin() + b * (trials + 1), marginals.begin() + (b + 1) * (trials + 1)), probabilities);
+		}
+
+		//Marsaglia-Tsang, with the shape < 1 boost
+		const Random::Gamma<double> gammaSmall(0.5, 2.0), gammaLarge(3.0, 0.5);
+		Kolmogorov("KS Gamma(0.5, 2)", [&](Random::Stream& s) { return 1 - GammaQ(0.5, gammaSmall(s) / 2.0); }, 1e6);
+		Kolmogorov("KS Gamma(3, 0.5)", [&](Random::Stream& s) { return 1 - GammaQ(3.0, gammaLarge(s) / 0.5); }, 1e6);
+
+		//Beta as a ratio of gammas. Beta(0.5, 0.5) is the arcsine distribution, and for integer
+		//parameters the CDF is a binomial tail: I_x(a, b) = P(Binomial(a + b - 1, x) >= a).
+		const double pi = 3.14159265358979323846;
+		const Random::Beta<double> arcsine(0.5, 0.5), beta25(2.0, 5.0);
+		Kolmogorov("KS Beta(0.5, 0.5)", [&](Random::Stream& s) { return 2 / pi * std::asin(std::sqrt(arcsine(s))); }, 1e6);
+		Kolmogorov("KS Beta(2, 5)", [&](Random::Stream& s) {
+			const double x = beta25(s);
+			double cdf = 0;
+			for (int j = 2; j <= 6; j++) {
+				cdf += std::exp(std::lgamma(7.0) - std::lgamma(j + 1.0) - std::lgamma(7.0 - j)) * std::pow(x, j) * std::pow(1 - x, 6 - j);
+			}
+			return cdf;
+		}, 1e6);
+	}
+
+	/// <summary>
+	/// MultivariateNormal against its mean and covariance. The samples are whitened with the known
+	/// Cholesky factor, so the coordinates should be independent standard normals: n times the squared
+	/// mean is chi-square with d degrees of freedom, and the entries of the second moment matrix give
+	/// d(d + 1) / 2 independent z-scores (variance 2 / n on the diagonal, 1 / n off it).
+	/// </summary>
+	void MultivariateNormalMoments()
+	{
+		constexpr std::size_t d = 3;
+		const double l[d][d] = { { 2.0, 0.0, 0.0 }, { 0.6, 1.0, 0.0 }, { -0.4, 0.5, 0.8 } };
+		const std::vector<double> mean = { 1.0, -2.0, 0.5 };
+		std::vector<double> covariance(d * d, 0.0);
+		for (std::size_t r = 0; r < d; r++) {
+			for (std::size_t c = 0; c < d; c++) {
+				for (std::size_t k = 0; k < d; k++) {
+					covariance[r * d + c] += l[r][k] * l[c][k];
+				}
+			}
+		}
+		const Random::MultivariateNormal<double> mvn(mean, covariance);
+
+		//per chunk: sums of the whitened coordinates, then of their pairwise products
+		const std::uint64_t n = Scaled(2e6);
+		const std::vector<double> sums = Parallel(n, 64, std::vector<double>(d + d * d, 0.0),
+			[&](Random::Stream& stream, std::uint64_t count, std::vector<double>& acc) {
+				//Fill writes structure-of-arrays: component r of vector i is at r * count + i
+				std::vector<double> x(d * count);
+				mvn.Fill(stream, x.data(), count);
+				for (std::uint64_t i = 0; i < count; i++) {
+					double y[d];
+					for (std::size_t r = 0; r < d; r++) {
+						double v = x[r * count + i] - mean[r];
+						for (std::size_t k = 0; k < r; k++) {
+							v -= l[r][k] * y[k];
+						}
+						y[r] = v / l[r][r];
+						acc[r] += y[r];
+					}
+					for (std::size_t r = 0; r < d; r++) {
+						for (std::size_t c = 0; c < d; c++) {
+							acc[d + r * d + c] += y[r] * y[c];
+						}
+					}
+				}
+			},
+			[](std::vector<double>& total, const std::vector<double>& part) {
+				for (std::size_t i = 0; i < total.size(); i++) {
+					total[i] += part[i];
+				}
+			});
+
+		const double count = static_cast<double>(n);
+		double meanStatistic = 0;
+		for (std::size_t r = 0; r < d; r++) {
+			meanStatistic += sums[r] * sums[r] / count;
+		}
+		Report("chi-square MultivariateNormal(3) mean", meanStatistic, ChiSquareP(meanStatistic, d));
+
+		double covarianceStatistic = 0;
+		for (std::size_t r = 0; r < d; r++) {
+			for (std::size_t c = 0; c <= r; c++) {
+				const double moment = sums[d + r * d + c] / count;
+				const double z = r == c ? (moment - 1) / std::sqrt(2 / count) : moment / std::sqrt(1 / count);
+				covarianceStatistic += z * z;
+			}
+		}
+		Report("chi-square MultivariateNormal(3) covariance", covarianceStatistic, ChiSquareP(covarianceStatistic, d * (d + 1) / 2.0));
+	}
+
+	/// <summary>
+	/// The stateless hash functions, over consecutive ids, ticks and salts.
+	/// </summary>
+	void Hashes()
+	{
+		const std::uint64_t n = Scaled(2e6);
+		Counts ints(100), chances(2), ticks(256), salts(256);
+		std::vector<double> floats(n);
+		for (std::uint64_t id = 0; id < n; id++) {
+			ints[Random::HashInt(0, 99, options.seed, id)]++;
+			floats[id] = Random::HashFloat(0.0, 1.0, options.seed, id, 0, 1);
+			chances[Random::HashChance(0.3, options.seed, id, 0, 2) ? 1 : 0]++;
+			ticks[Random::HashInt(0, 15, options.seed, id, 1) * 16 + Random::HashInt(0, 15, options.seed, id, 2)]++;
+			salts[Random::HashInt(0, 15, options.seed, id, 0, 3) * 16 + Random::HashInt(0, 15, options.seed, id, 0, 4)]++;
+		}
+		ChiSquareUniform("chi-square HashInt [0, 100) over ids", ints);
+		const double d = KolmogorovD(floats);
+		Report("KS HashFloat<double> over ids", d, KolmogorovP(d, static_cast<double>(n)));
+		ChiSquare("chi-square HashChance(0.3) over ids", chances, { 0.7, 0.3 }, 1);
+		ChiSquareUniform("pairs HashInt [0, 16) adjacent ticks", ticks);
+		ChiSquareUniform("pairs HashInt [0, 16) adjacent salts", salts);
+	}
+
+	/// <summary>
+	/// Each one-dimensional projection of the first 2^m scrambled Sobol points, and of the first b^m
+	/// rotated Halton points in base b, has exactly one point in each of the 2^m (b^m) equal cells.
+	/// The randomization has to keep that, and has to make every single point uniform, which is
+	/// checked over many independent scramblings.
+	/// </summary>
+	void LowDiscrepancy()
+	{
+		Random::Seed(options.seed);
+		const std::size_t points = 4096;
+
+		Random::Sobol<double> sobol(Random::Sobol<double>::MaxDimensions);
+		std::vector<double> sobolPoints(sobol.Dimensions() * points);
+		sobol.Fill(sobolPoints.data(), points);
+		std::size_t sobolBad = 0;
+		for (std::size_t d = 0; d < sobol.Dimensions(); d++) {
+			Counts cells(points);
+			for (std::size_t i = 0; i < points; i++) {
+				cells[static_cast<std::size_t>(sobolPoints[d * points + i] * points)]++;
+			}
+			sobolBad += points - static_cast<std::size_t>(std::count(cells.begin(), cells.end(), 1));
+		}
+		Expect("Sobol stratification 37 dims, 2^12 points", static_cast<double>(sobolBad), sobolBad == 0);
+
+		Random::Halton<double> halton(8);
+		std::vector<double> haltonPoints(halton.Dimensions() * points);
+		halton.Fill(haltonPoints.data(), points);
+		const std::uint32_t bases[] = { 2, 3, 5, 7, 11, 13, 17, 19 };
+		std::size_t haltonBad = 0;
+		for (std::size_t d = 0; d < halton.Dimensions(); d++) {
+			std::size_t size = 1;
+			while (size * bases[d] <= points) {
+				size *= bases[d];
+			}
+			Counts cells(size);
+			for (std::size_t i = 0; i < size; i++) {
+				cells[std::min(size - 1, static_cast<std::size_t>(haltonPoints[d * points + i] * size))]++;
+			}
+			haltonBad += size - static_cast<std::size_t>(std::count(cells.begin(), cells.end(), 1));
+		}
+		Expect("Halton stratification 8 dims, b^m points", static_cast<double>(haltonBad), haltonBad == 0);
+
+		Kolmogorov("KS Sobol point 37 dim 8 over scramblings", [](Random::Stream& s) {
+			Random::Sobol<double> sequence(8, false);
+			sequence.Rescramble(s);
+			sequence.Seek(37);
+			double point[8];
+			sequence.Next(point);
+			return point[7];
+		}, 2e5);
+		Kolmogorov("KS Halton point 37 dim 8 over rotations", [](Random::Stream& s) {
+			Random::Halton<double> sequence(8, false);
+			sequence.Rescramble(s);
+			sequence.Seek(37);
+			double point[8];
+			sequence.Next(point);
+			return point[7];
+		}, 2e5);
+	}
+
+#ifdef RANDOM_HAS_POSIX
+	/// <summary>
+	/// ShuffleFile in place with a budget of 0, which is raised to the minimum, and into another file
+	/// with a 64 KiB budget. Both split the file into buckets. Every output has to be a permutation of
+	/// the intact records, and each record has to land in each position equally often.
+	/// </summary>
+	void Files()
+	{
+		const std::size_t records = 16;
+		const std::size_t recordSize = 4096;
+		const std::string path = (std::filesystem::temp_directory_path() / ("random_quality_" + std::to_string(::getpid()) + ".bin")).string();
+		const std::string outPath = path + ".out";
+
+		std::vector<unsigned char> original(records * recordSize);
+		for (std::size_t i = 0; i < original.size(); i++) {
+			original[i] = static_cast<unsigned char>(i % recordSize == 0 ? i / recordSize : i * 131 / recordSize + i);
+		}
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		std::fwrite(original.data(), 1, original.size(), file);
+		std::fclose(file);
+
+		//adds the position of each record to positions and returns false if the records aren't intact
+		std::vector<unsigned char> bytes(original.size());
+		const auto check = [&](const std::string& name, Counts& positions) {
+			std::FILE* f = std::fopen(name.c_str(), "rb");
+			const bool read = f && std::fread(bytes.data(), 1, bytes.size(), f) == bytes.size();
+			if (f) {
+				std::fclose(f);
+			}
+			std::vector<bool> seen(records, false);
+			for (std::size_t p = 0; read && p < records; p++) {
+				const std::size_t r = bytes[p * recordSize];
+				if (r >= records || seen[r] || std::memcmp(&bytes[p * recordSize], &original[r * recordSize], recordSize) != 0) {
+					return false;
+				}
+				seen[r] = true;
+				positions[r * records + p]++;
+			}
+			return read;
+		};
+
+		Random::Seed(options.seed);
+		const std::uint64_t repetitions = Scaled(2000);
+		Counts positions(records * records);
+		std::uint64_t broken = 0;
+		for (std::uint64_t i = 0; i < repetitions; i++) {
+			Random::ShuffleFile(path, recordSize, 0);
+			broken += !check(path, positions);
+		}
+		Expect("ShuffleFile 4 KiB records, 0 budget intact", static_cast<double>(broken), broken == 0);
+		ChiSquare("positions ShuffleFile 4 KiB records, 0 budget", positions,
+			std::vector<double>(records * records, 1.0 / (records * records)), (records - 1.0) * (records - 1.0));
+
+		Counts buffered(records * records);
+		broken = 0;
+		for (std::uint64_t i = 0; i < repetitions; i++) {
+			Random::ShuffleFile(path, outPath, recordSize, records * recordSize);
+			broken += !check(outPath, buffered);
+		}
+		Expect("ShuffleFile 4 KiB records, 64 KiB budget intact", static_cast<double>(broken), broken == 0);
+		ChiSquare("positions ShuffleFile 4 KiB records, 64 KiB budget", buffered,
+			std::vector<double>(records * records, 1.0 / (records * records)), (records - 1.0) * (records - 1.0));
+
+		std::remove(path.c_str());
+		std::remove(outPath.c_str());
+	}
+#endif
+
+	//-------------------------------------------------------------------------------------------------
+	// global
+
+	/// <summary>
+	/// The global functions share one engine, so they are checked on a single thread.
+	/// </summary>
+	void Global()
+	{
+		Random::Seed(options.seed);
+		const std::uint64_t n = Scaled(1e6);
+
+		Counts dice(6);
+		for (std::uint64_t i = 0; i < n; i++) {
+			dice[Random::GetInt(1, 6) - 1]++;
+		}
+		ChiSquareUniform("global chi-square GetInt [1, 6]", dice);
+
+		std::vector<double> floats(n);
+		for (double& u : floats) {
+			u = Random::GetFloat(0.0, 1.0);
+		}
+		const double d = KolmogorovD(floats);
+		Report("global KS GetFloat<double>", d, KolmogorovP(d, static_cast<double>(n)));
+
+		std::vector<double> normals(n);
+		for (double& u : normals) {
+			u = NormalCdf(Random::GetFloatNormal(0.0, 1.0));
+		}
+		const double dn = KolmogorovD(normals);
+		Report("global KS GetFloatNormal<double>", dn, KolmogorovP(dn, static_cast<double>(n)));
+
+		Counts perms(120);
+		std::array<int, 5> values = { 0, 1, 2, 3, 4 };
+		for (std::uint64_t i = 0; i < n; i++) {
+			Random::Shuffle(values);
+			perms[Lehmer(values)]++;
+		}
+		ChiSquareUniform("global permutations Shuffle n=5", perms);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--scale" && i + 1 < argc) {
+			options.scale = std::strtod(argv[++i], nullptr);
+		} else if (arg == "--threads" && i + 1 < argc) {
+			options.threads = std::max(1, std::atoi(argv[++i]));
+		} else if (arg == "--seed" && i + 1 < argc) {
+			options.seed = std::strtoull(argv[++i], nullptr, 0);
+		} else if (arg == "--alpha" && i + 1 < argc) {
+			options.alpha = std::strtod(argv[++i], nullptr);
+		} else {
+			std::fprintf(stderr, "usage: %s [--scale factor] [--threads n] [--seed value] [--alpha p]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	std::printf("seed 0x%llx, scale %g, %u threads\n", static_cast<unsigned long long>(options.seed), options.scale, options.threads);
+
+	BoundedInts<int>(2);
+	BoundedInts<int>(6);
+	BoundedInts<int>(7);
+	BoundedInts<std::uint32_t>(1000);
+	BoundedInts<std::int64_t>(100);
+	WideInts();
+	Bytes();
+	Chance();
+	FloatBins<float>("float");
+	FloatBins<double>("double");
+	Kolmogorov("KS GetFloat<float>", [](Random::Stream& s) { return static_cast<double>(s.GetFloat(0.0f, 1.0f)); });
+	Kolmogorov("KS GetFloat<double>", [](Random::Stream& s) { return s.GetFloat(0.0, 1.0); });
+	Kolmogorov("KS GetFloatNormal<double>", [](Random::Stream& s) { return NormalCdf(s.GetFloatNormal(0.0, 1.0)); });
+	Kolmogorov("KS Normal<double> sampler", [](Random::Stream& s) { return NormalCdf(Random::Normal<double>(0.0, 1.0)(s)); });
+	BirthdaySpacings();
+	Gaps();
+	Permutations();
+	Samplers();
+	MultivariateNormalMoments();
+	Hashes();
+	LowDiscrepancy();
+#ifdef RANDOM_HAS_POSIX
+	Files();
+#endif
+	Global();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("%d failure(s), %.2f s\n", failures, seconds);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,57 @@
+///C++20 ranges test for Random::Sequence, run by CTest. Built as C++20, where a Sequence is a
+///std::ranges::view and composes with the std::views adaptors.
+#include "Random.hpp"
+
+#include <cstdio>
+#include <vector>
+
+#if defined(__cpp_lib_ranges)
+#include <ranges>
+#endif
+
+int main()
+{
+#if defined(__cpp_lib_ranges)
+	int failures = 0;
+	const auto expect = [&](const char* name, bool ok) {
+		std::printf("%s %s\n", ok ? "  ok  " : "  FAIL", name);
+		failures += ok ? 0 : 1;
+	};
+
+	static_assert(std::ranges::view<Random::Sequence<Random::Normal<double>>>);
+	static_assert(std::ranges::input_range<Random::Sequence<Random::Normal<double>>>);
+
+	Random::Seed(0x5EED);
+	std::vector<int> fromView;
+	for (int v : Random::Ints(1, 6) | std::views::take(1000)) {
+		fromView.push_back(v);
+	}
+	Random::Seed(0x5EED);
+	std::vector<int> direct;
+	for (int i = 0; i < 1000; i++) {
+		direct.push_back(Random::GetInt(1, 6));
+	}
+	expect("Ints | views::take draws the same values as GetInt", fromView == direct);
+
+	Random::Stream a(0x5EED, 1);
+	Random::Stream b(0x5EED, 1);
+	Random::Normal<double> normal;
+	bool same = true;
+	int taken = 0;
+	for (double v : Random::Values(Random::Normal<double>(), a) | std::views::filter([](double x) { return x > 0; }) | std::views::take(100)) {
+		double expected = normal(b);
+		while (expected <= 0) {
+			expected = normal(b);
+		}
+		same = same && v == expected;
+		taken++;
+	}
+	expect("Values | views::filter | views::take matches the sampler", same && taken == 100);
+
+	std::printf("%d failure(s)\n", failures);
+	return failures ? 1 : 0;
+#else
+	std::printf("skipped: no std::ranges\n");
+	return 0;
+#endif
+}
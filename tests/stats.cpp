@@ -0,0 +1,135 @@
+///Instrumentation tests for Random, run by CTest. Built with RANDOM_ENABLE_STATS.
+///Makes a known number of calls to each group of the global API and checks the counters, including
+///the reseed counted in a forked child.
+#include "Random.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	int failures = 0;
+
+	void Expect(const char* name, bool ok)
+	{
+		std::printf("%s %s\n", ok ? "  ok  " : "  FAIL", name);
+		std::fflush(stdout);
+		failures += ok ? 0 : 1;
+	}
+
+	std::uint64_t Calls(const Random::StatsSnapshot& stats, Random::Api api)
+	{
+		return stats.calls[static_cast<std::size_t>(api)];
+	}
+
+	std::uint64_t Steps(const Random::StatsSnapshot& stats, Random::Api api)
+	{
+		return stats.steps[static_cast<std::size_t>(api)];
+	}
+
+	void Calls()
+	{
+		Random::ResetStats();
+		Random::Recorder recorder;
+		for (int i = 0; i < 100; i++) {
+			Random::GetInt(0, 1000);
+		}
+		for (int i = 0; i < 50; i++) {
+			Random::GetFloat(0.0, 1.0);
+		}
+		for (int i = 0; i < 25; i++) {
+			Random::Chance(0.5);
+		}
+		std::vector<int> values(100);
+		for (int i = 0; i < 3; i++) {
+			Random::Shuffle(values.begin(), values.end());
+		}
+		Random::GetIntVector(1000, 0, 9);
+		Random::GetFloatVector(1000, 0.0, 1.0);
+		int sum = 0;
+		for (int v : Random::Ints(1, 6).Take(200)) {
+			sum += v;
+		}
+		const Random::StatsSnapshot stats = Random::Stats();
+
+		Expect("Stats is enabled", stats.enabled);
+		Expect("GetInt counts 100 calls", Calls(stats, Random::Api::GetInt) == 100 && Steps(stats, Random::Api::GetInt) >= 100);
+		Expect("GetFloat counts 50 calls", Calls(stats, Random::Api::GetFloat) == 50 && Steps(stats, Random::Api::GetFloat) >= 50);
+		Expect("Chance counts 25 calls", Calls(stats, Random::Api::Chance) == 25 && Steps(stats, Random::Api::Chance) >= 25);
+		//std::shuffle may take two swap positions from one draw, so 100 elements need at least 50 steps
+		Expect("Shuffle counts 3 calls", Calls(stats, Random::Api::Shuffle) == 3 && Steps(stats, Random::Api::Shuffle) >= 3 * 50);
+		Expect("vectors count 2 calls under Arrays", Calls(stats, Random::Api::Arrays) == 2 && Steps(stats, Random::Api::Arrays) >= 2000);
+		Expect("Ints range counts its 200 draws under Ranges", sum > 0 && Steps(stats, Random::Api::Ranges) >= 200);
+		Expect("untouched APIs count nothing", Calls(stats, Random::Api::GetByte) == 0 && Calls(stats, Random::Api::Files) == 0);
+
+		std::uint64_t total = 0;
+		for (std::uint64_t steps : stats.steps) {
+			total += steps;
+		}
+		Expect("engineSteps is the sum over APIs", stats.engineSteps == total);
+		Expect("engineSteps matches the engine's distance", stats.engineSteps == recorder.Draws());
+
+		Random::ResetStats();
+		const Random::StatsSnapshot reset = Random::Stats();
+		Expect("ResetStats clears the counters", reset.engineSteps == 0 && reset.reseeds == 0 && Calls(reset, Random::Api::GetInt) == 0);
+	}
+
+	void Threads()
+	{
+		constexpr int threadCount = 4;
+		constexpr int callsPerThread = 1000;
+		Random::ResetStats();
+		std::vector<std::thread> threads;
+		for (int t = 0; t < threadCount; t++) {
+			threads.emplace_back([] {
+				for (int i = 0; i < callsPerThread; i++) {
+					Random::GetInt(0, 1000);
+				}
+			});
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+		const Random::StatsSnapshot stats = Random::Stats();
+		Expect("calls from finished threads are kept", Calls(stats, Random::Api::GetInt) == threadCount * callsPerThread);
+		Expect("each thread has its own counter block", stats.threads >= threadCount + 1);
+	}
+
+	void Reseeds()
+	{
+		Random::ResetStats();
+		Random::Seed(1);
+		Random::Seed(2, 3);
+		Random::Seed();
+		Expect("Seed counts 3 reseeds", Random::Stats().reseeds == 3);
+
+#if defined(__unix__) || defined(__APPLE__)
+		Random::ResetStats();
+		const pid_t child = fork();
+		if (child == 0) {
+			//the child reports through its exit code, since its stdout copy may be lost
+			_exit(Random::Stats().reseeds == 1 ? 0 : 1);
+		}
+		int status = 0;
+		const bool waited = child > 0 && waitpid(child, &status, 0) == child;
+		Expect("a forked child counts its reseed", waited && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+		Expect("the parent does not count the child's reseed", Random::Stats().reseeds == 0);
+#endif
+	}
+}
+
+int main()
+{
+	Calls();
+	Threads();
+	Reseeds();
+	std::printf("%d failure(s)\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,582 @@
+///Functional tests for Random, run by CTest.
+///Unlike the quality battery, every check here holds exactly: round trips, replays, argument
+///validation and the bookkeeping of the higher-level APIs.
+#include "Random.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <list>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef RANDOM_HAS_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	int failures = 0;
+
+	void Expect(const char* name, bool ok)
+	{
+		std::printf("%s %s\n", ok ? "  ok  " : "  FAIL", name);
+		std::fflush(stdout);
+		failures += ok ? 0 : 1;
+	}
+
+	template<typename Function_t>
+	bool Rejects(Function_t function)
+	{
+		try {
+			function();
+		}
+		catch (const std::invalid_argument&) {
+			return true;
+		}
+		return false;
+	}
+
+	template<typename Engine_t>
+	std::vector<std::uint32_t> Draw(Engine_t& engine, std::size_t count)
+	{
+		std::vector<std::uint32_t> values(count);
+		for (std::uint32_t& v : values) {
+			v = static_cast<std::uint32_t>(engine());
+		}
+		return values;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// state
+
+	void State()
+	{
+		constexpr std::size_t count = 1000;
+
+		unsigned char buffer[Random::StateSize];
+		Expect("SaveState writes StateSize bytes", Random::SaveState(buffer, sizeof(buffer)) == Random::StateSize);
+		const std::vector<int> first = Random::GetIntVector(count, 0, 1 << 30);
+		Expect("RestoreState reads StateSize bytes", Random::RestoreState(buffer, sizeof(buffer)) == Random::StateSize);
+		Expect("global generator replays after RestoreState", Random::GetIntVector(count, 0, 1 << 30) == first);
+
+		Random::Stream stream(0x5EED, 7);
+		unsigned char streamBuffer[sizeof(Random::Stream)];
+		Random::SaveState(stream, streamBuffer, sizeof(streamBuffer));
+		const std::vector<std::uint32_t> fromStream = Draw(stream, count);
+		Random::RestoreState(stream, streamBuffer, sizeof(streamBuffer));
+		Expect("Stream replays after RestoreState", Draw(stream, count) == fromStream);
+
+		Random::Philox philox(0x5EED, 7, 3);
+		unsigned char philoxBuffer[sizeof(Random::Philox)];
+		Random::SaveState(philox, philoxBuffer, sizeof(philoxBuffer));
+		const std::vector<std::uint32_t> fromPhilox = Draw(philox, count);
+		Random::RestoreState(philox, philoxBuffer, sizeof(philoxBuffer));
+		Expect("Philox replays after RestoreState", Draw(philox, count) == fromPhilox);
+
+		std::vector<Random::Stream> streams;
+		for (std::uint64_t id = 0; id < 4; id++) {
+			streams.emplace_back(0x5EED, id);
+		}
+		std::vector<unsigned char> states(streams.size() * sizeof(Random::Stream));
+		Random::SaveStates(streams.data(), streams.size(), states.data(), states.size());
+		std::vector<std::uint32_t> fromStreams;
+		for (Random::Stream& s : streams) {
+			const std::vector<std::uint32_t> values = Draw(s, count);
+			fromStreams.insert(fromStreams.end(), values.begin(), values.end());
+		}
+		Random::RestoreStates(streams.data(), streams.size(), states.data(), states.size());
+		std::vector<std::uint32_t> replayed;
+		for (Random::Stream& s : streams) {
+			const std::vector<std::uint32_t> values = Draw(s, count);
+			replayed.insert(replayed.end(), values.begin(), values.end());
+		}
+		Expect("Stream array replays after RestoreStates", replayed == fromStreams);
+
+		Expect("SaveState rejects a small buffer", Rejects([&] { Random::SaveState(buffer, sizeof(buffer) - 1); }));
+		Expect("RestoreState rejects a truncated state", Rejects([&] { Random::RestoreState(buffer, sizeof(buffer) - 1); }));
+		Expect("RestoreState rejects an oversized state", Rejects([&] { Random::RestoreState(buffer, sizeof(buffer) + 1); }));
+		Expect("RestoreStates rejects a missing engine",
+			Rejects([&] { Random::RestoreStates(streams.data(), streams.size(), states.data(), states.size() - sizeof(Random::Stream)); }));
+
+		//a rejected restore must leave the engine alone
+		Random::Philox before = philox;
+		const bool rejected = Rejects([&] { Random::RestoreState(philox, streamBuffer, sizeof(streamBuffer)); });
+		Expect("RestoreState rejects another engine's state", sizeof(Random::Stream) == sizeof(Random::Philox) || rejected);
+		Expect("rejected RestoreState keeps the engine", Draw(philox, count) == Draw(before, count));
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// shuffling
+
+	void Shuffling()
+	{
+		std::vector<int> source(1000);
+		std::iota(source.begin(), source.end(), 0);
+		const std::vector<int> original = source;
+
+		std::vector<int> out(source.size());
+		const auto end = Random::ShuffleInto(source.begin(), source.end(), out.begin());
+		std::vector<int> sorted = out;
+		std::sort(sorted.begin(), sorted.end());
+		Expect("ShuffleInto returns the end of the output", end == out.end());
+		Expect("ShuffleInto writes a permutation", sorted == original);
+		Expect("ShuffleInto leaves the source alone", source == original);
+		Expect("ShuffleInto reorders", out != original);
+
+		//a list only has bidirectional iterators, the source side needs no more than input iterators
+		const std::list<int> list(source.begin(), source.end());
+		std::vector<int> fromList(list.size());
+		Random::ShuffleInto(list.begin(), list.end(), fromList.begin());
+		std::sort(fromList.begin(), fromList.end());
+		Expect("ShuffleInto from a list writes a permutation", fromList == original);
+
+		std::vector<int> one(1);
+		Expect("ShuffleInto of an empty range writes nothing", Random::ShuffleInto(source.begin(), source.begin(), one.begin()) == one.begin());
+		Random::ShuffleInto(source.begin(), source.begin() + 1, one.begin());
+		Expect("ShuffleInto of one element copies it", one[0] == source[0]);
+
+		Random::Stream a(0x5EED, 1);
+		Random::Stream b(0x5EED, 1);
+		std::vector<int> fromA(source.size());
+		std::vector<int> fromB(source.size());
+		a.ShuffleInto(source.begin(), source.end(), fromA.begin());
+		b.ShuffleInto(source.begin(), source.end(), fromB.begin());
+		Expect("ShuffleInto is deterministic for a fixed Stream seed", fromA == fromB);
+
+		Random::Seed(0x5EED);
+		Random::ShuffleInto(source.begin(), source.end(), fromA.begin());
+		Random::Seed(0x5EED);
+		Random::ShuffleInto(source.begin(), source.end(), fromB.begin());
+		Expect("ShuffleInto is deterministic for a fixed global seed", fromA == fromB);
+	}
+
+#ifdef RANDOM_HAS_POSIX
+	//-------------------------------------------------------------------------------------------------
+	// files
+
+	std::string TempPath(const char* name)
+	{
+		return (std::filesystem::temp_directory_path() / ("random_unit_" + std::to_string(::getpid()) + "_" + name)).string();
+	}
+
+	//a file of count 8-byte records, each holding its own index
+	void WriteIndexFile(const std::string& path, std::uint64_t count)
+	{
+		std::vector<std::uint64_t> records(count);
+		std::iota(records.begin(), records.end(), std::uint64_t(0));
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		std::fwrite(records.data(), sizeof(std::uint64_t), records.size(), file);
+		std::fclose(file);
+	}
+
+	std::vector<std::uint64_t> ReadIndexFile(const std::string& path)
+	{
+		std::vector<std::uint64_t> records(std::filesystem::file_size(path) / sizeof(std::uint64_t));
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		const bool read = file && std::fread(records.data(), sizeof(std::uint64_t), records.size(), file) == records.size();
+		if (file) {
+			std::fclose(file);
+		}
+		return read ? records : std::vector<std::uint64_t>();
+	}
+
+	void Files()
+	{
+		constexpr std::uint64_t count = 10000;
+		const std::string path = TempPath("records.bin");
+		WriteIndexFile(path, count);
+
+		const std::vector<unsigned char> sample = Random::SampleFile(path, sizeof(std::uint64_t), 100);
+		std::vector<std::uint64_t> picked(sample.size() / sizeof(std::uint64_t));
+		std::memcpy(picked.data(), sample.data(), picked.size() * sizeof(std::uint64_t));
+		Expect("SampleFile returns k records", sample.size() == 100 * sizeof(std::uint64_t));
+		Expect("SampleFile returns distinct records in file order", std::adjacent_find(picked.begin(), picked.end(),
+			[](std::uint64_t a, std::uint64_t b) { return a >= b; }) == picked.end());
+		Expect("SampleFile returns intact records", picked.back() < count);
+
+		const std::vector<unsigned char> all = Random::SampleFile(path, sizeof(std::uint64_t), count);
+		std::vector<std::uint64_t> expected(count);
+		std::iota(expected.begin(), expected.end(), std::uint64_t(0));
+		Expect("SampleFile of every record returns the file", all.size() == count * sizeof(std::uint64_t)
+			&& std::memcmp(all.data(), expected.data(), all.size()) == 0);
+		Expect("SampleFile of 0 records is empty", Random::SampleFile(path, sizeof(std::uint64_t), 0).empty());
+		Expect("SampleFile rejects k over the record count", Rejects([&] { Random::SampleFile(path, sizeof(std::uint64_t), count + 1); }));
+		Expect("SampleFile rejects a partial record", Rejects([&] { Random::SampleFile(path, 3, 1); }));
+
+		//a budget of 0 is raised to the minimum, which still splits the file into buckets
+		Random::ShuffleFile(path, sizeof(std::uint64_t), 0);
+		std::vector<std::uint64_t> shuffled = ReadIndexFile(path);
+		const bool moved = shuffled != expected;
+		std::sort(shuffled.begin(), shuffled.end());
+		Expect("ShuffleFile with a 0 budget writes a permutation", moved && shuffled == expected);
+		Expect("ShuffleFile rejects a partial record", Rejects([&] { Random::ShuffleFile(path, 3); }));
+		std::remove(path.c_str());
+
+		const std::string bytesPath = TempPath("bytes.bin");
+		for (const std::uint64_t size : { std::uint64_t(0), std::uint64_t(1), std::uint64_t(12345), std::uint64_t(1) << 20 }) {
+			const int fd = ::open(bytesPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+			Random::WriteBytes(fd, size, 4096);
+			::close(fd);
+			const std::string name = "WriteBytes writes " + std::to_string(size) + " bytes";
+			Expect(name.c_str(), std::filesystem::file_size(bytesPath) == size);
+		}
+		std::remove(bytesPath.c_str());
+	}
+#endif
+
+	//-------------------------------------------------------------------------------------------------
+	// weights
+
+	void Weights()
+	{
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+		const double inf = std::numeric_limits<double>::infinity();
+		const double max = std::numeric_limits<double>::max();
+		const std::vector<std::vector<double>> invalid = {
+			{}, { 0, 0, 0 }, { 1, -1, 2 }, { 1, nan }, { 1, inf }, { max, max }
+		};
+		bool categorical = true;
+		bool multinomial = true;
+		for (const std::vector<double>& weights : invalid) {
+			categorical = categorical && Rejects([&] { Random::Categorical<int>(weights.begin(), weights.end()); });
+			multinomial = multinomial && Rejects([&] { Random::Multinomial(weights.begin(), weights.end()); });
+		}
+		Expect("Categorical rejects empty, zero, negative and non-finite weights", categorical);
+		Expect("Multinomial rejects empty, zero, negative and non-finite weights", multinomial);
+
+		Random::Stream stream(0x5EED, 1);
+		const Random::Categorical<int> onlyOne = { 0, 1, 0 };
+		bool picked = true;
+		for (int i = 0; i < 1000; i++) {
+			picked = picked && onlyOne(stream) == 1;
+		}
+		Expect("Categorical never picks a zero weight", picked);
+
+		const Random::Multinomial split = { 0, 1, 0 };
+		std::vector<std::uint64_t> counts(split.Size());
+		split.Counts(stream, 1000, counts.begin());
+		Expect("Multinomial puts every trial in the only positive bucket", counts == std::vector<std::uint64_t>{ 0, 1000, 0 });
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// shapes
+
+	//Every point has to be inside (or on) its shape, up to a few units of rounding.
+	template<typename Float_t>
+	void Shapes(const char* type)
+	{
+		constexpr std::size_t count = 100000;
+		const Float_t tolerance = 16 * std::numeric_limits<Float_t>::epsilon();
+		const Float_t radius = 2;
+		std::vector<Float_t> x(count), y(count), z(count), w(count);
+		const auto expect = [type](const char* shape, bool ok) {
+			const std::string name = std::string(shape) + " " + type;
+			Expect(name.c_str(), ok);
+		};
+		const auto all = [](auto predicate) {
+			bool ok = true;
+			for (std::size_t i = 0; i < count; i++) {
+				ok = ok && predicate(i);
+			}
+			return ok;
+		};
+
+		Random::GetPointsInDisk(x.data(), y.data(), count, radius);
+		expect("GetPointsInDisk inside the disk", all([&](std::size_t i) {
+			return std::hypot(x[i], y[i]) <= radius * (1 + tolerance);
+		}));
+		Random::GetPointsOnCircle(x.data(), y.data(), count, radius);
+		expect("GetPointsOnCircle on the circle", all([&](std::size_t i) {
+			return std::fabs(std::hypot(x[i], y[i]) - radius) <= radius * tolerance;
+		}));
+		Random::GetPointsOnSphere(x.data(), y.data(), z.data(), count, radius);
+		expect("GetPointsOnSphere on the sphere", all([&](std::size_t i) {
+			return std::fabs(std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]) - radius) <= radius * tolerance;
+		}));
+		Random::GetPointsInBall(x.data(), y.data(), z.data(), count, radius);
+		expect("GetPointsInBall inside the ball", all([&](std::size_t i) {
+			return std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]) <= radius * (1 + tolerance);
+		}));
+
+		//barycentric coordinates of p in abc, all between 0 and 1 inside the triangle
+		const std::array<Float_t, 2> a = { -1, 0 }, b = { 3, 1 }, c = { 0, 4 };
+		Random::GetPointsInTriangle(x.data(), y.data(), count, a, b, c);
+		expect("GetPointsInTriangle inside the 2D triangle", all([&](std::size_t i) {
+			const Float_t area = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+			const Float_t u = ((b[0] - x[i]) * (c[1] - y[i]) - (c[0] - x[i]) * (b[1] - y[i])) / area;
+			const Float_t v = ((c[0] - x[i]) * (a[1] - y[i]) - (a[0] - x[i]) * (c[1] - y[i])) / area;
+			return u >= -tolerance && v >= -tolerance && u + v <= 1 + tolerance;
+		}));
+
+		//a triangle in the plane z = x + y: points have to stay in the plane and inside its projection
+		const std::array<Float_t, 3> a3 = { -1, 0, -1 }, b3 = { 3, 1, 4 }, c3 = { 0, 4, 4 };
+		Random::GetPointsInTriangle(x.data(), y.data(), z.data(), count, a3, b3, c3);
+		expect("GetPointsInTriangle inside the 3D triangle", all([&](std::size_t i) {
+			const Float_t area = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+			const Float_t u = ((b[0] - x[i]) * (c[1] - y[i]) - (c[0] - x[i]) * (b[1] - y[i])) / area;
+			const Float_t v = ((c[0] - x[i]) * (a[1] - y[i]) - (a[0] - x[i]) * (c[1] - y[i])) / area;
+			const bool inPlane = std::fabs(z[i] - x[i] - y[i]) <= 8 * tolerance;
+			return inPlane && u >= -tolerance && v >= -tolerance && u + v <= 1 + tolerance;
+		}));
+
+		Random::GetUnitQuaternions(x.data(), y.data(), z.data(), w.data(), count);
+		expect("GetUnitQuaternions have unit length", all([&](std::size_t i) {
+			return std::fabs(std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i] + w[i] * w[i]) - 1) <= tolerance;
+		}));
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// ranges
+
+	void Ranges()
+	{
+		constexpr std::size_t count = 1000;
+
+		Random::Seed(0x5EED);
+		std::vector<int> fromRange;
+		for (int v : Random::Ints(1, 6).Take(count)) {
+			fromRange.push_back(v);
+		}
+		Random::Seed(0x5EED);
+		std::vector<int> direct;
+		for (std::size_t i = 0; i < count; i++) {
+			direct.push_back(Random::GetInt(1, 6));
+		}
+		Expect("Ints draws the same values as GetInt", fromRange == direct);
+
+		Random::Seed(0x5EED);
+		std::vector<double> floats;
+		for (double v : Random::Floats(0.0, 1.0).Take(count)) {
+			floats.push_back(v);
+		}
+		Random::Seed(0x5EED);
+		bool same = floats.size() == count;
+		for (std::size_t i = 0; same && i < count; i++) {
+			same = floats[i] == Random::GetFloat(0.0, 1.0);
+		}
+		Expect("Floats draws the same values as GetFloat", same);
+
+		Random::Stream a(0x5EED, 1);
+		Random::Stream b(0x5EED, 1);
+		Random::Normal<double> normal;
+		same = true;
+		std::size_t taken = 0;
+		for (double v : Random::Values(Random::Normal<double>(), a).Take(count)) {
+			same = same && v == normal(b);
+			taken++;
+		}
+		Expect("Values on a Stream draws the same values as the sampler", same && taken == count);
+
+		auto sequence = Random::Values(Random::Normal<double>(), a).Take(3);
+		auto it = sequence.begin();
+		const double first = *it++;
+		const double second = *it;
+		++it;
+		const double third = *it++;
+		Expect("post-increment returns the previous value", first == normal(b) && second == normal(b) && third == normal(b));
+		Expect("post-increment reaches the end", it == sequence.end());
+		Expect("Take(0) is empty", Random::Ints(1, 6).Take(0).begin() == Random::Ints(1, 6).end());
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// low-discrepancy sequences
+
+	void LowDiscrepancy()
+	{
+		//unscrambled base 2 maps 2^k - 1 to 1 - 2^-k, which rounds to 1 as a float from k = 25 on
+		bool below = true;
+		for (int k = 20; k < 60; k++) {
+			Random::Halton<float> halton(1, false);
+			halton.Seek((std::uint64_t(1) << k) - 1);
+			float next = 0;
+			float filled = 0;
+			halton.Next(&next);
+			halton.Seek((std::uint64_t(1) << k) - 1);
+			halton.Fill(&filled, 1);
+			below = below && next < 1.0f && filled < 1.0f && next >= 0.0f;
+		}
+		Expect("Halton<float> stays below 1", below);
+
+		Random::Halton<double> halton(1, false);
+		halton.Seek((std::uint64_t(1) << 40) - 1);
+		double next = 0;
+		halton.Next(&next);
+		Expect("Halton<double> keeps full precision near 1", next == 1.0 - std::ldexp(1.0, -40));
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// background generation
+
+	//Numbers its calls, so a queue's values show the order its copy of the sampler produced them in.
+	struct Counter
+	{
+		mutable std::uint64_t next = 0;
+
+		template<typename Stream_t>
+		std::uint64_t operator()(Stream_t&) const { return next++; }
+	};
+
+	//Takes count values that the producer made, waiting for it rather than generating inline.
+	template<typename Queue_t>
+	std::vector<typename Queue_t::value_type> Produced(Queue_t& queue, std::size_t count)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+		std::vector<typename Queue_t::value_type> values;
+		typename Queue_t::value_type value;
+		while (values.size() < count && std::chrono::steady_clock::now() < deadline) {
+			if (queue.TryPop(value)) {
+				values.push_back(value);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+		return values;
+	}
+
+	std::vector<std::uint64_t> Counted(std::size_t count)
+	{
+		std::vector<std::uint64_t> values(count);
+		std::iota(values.begin(), values.end(), std::uint64_t(0));
+		return values;
+	}
+
+	void Background()
+	{
+		//many times the capacity, so the producer has to be woken again and again
+		constexpr std::size_t count = 100000;
+		{
+			Random::AsyncProducer producer(true);
+			auto queue = producer.MakeQueue(Counter(), 64);
+			Expect("AsyncProducer delivers values in production order", Produced(*queue, count) == Counted(count));
+		}
+		{
+			Random::AsyncProducer producer(true);
+			std::vector<std::thread> consumers;
+			std::vector<char> ordered(4, 0);
+			for (std::size_t t = 0; t < ordered.size(); t++) {
+				auto queue = producer.MakeQueue(Counter(), 256);
+				consumers.emplace_back([queue, t, &ordered] { ordered[t] = Produced(*queue, count) == Counted(count); });
+			}
+			for (std::thread& consumer : consumers) {
+				consumer.join();
+			}
+			Expect("AsyncProducer keeps every consumer's queue in order", std::all_of(ordered.begin(), ordered.end(), [](char ok) { return ok != 0; }));
+		}
+
+		const auto values = [](std::uint64_t seed) {
+			Random::Seed(seed);
+			Random::AsyncProducer producer(true);
+			auto queue = producer.MakeQueue([](Random::Stream& s) { return s(); }, 128);
+			return Produced(*queue, 1000);
+		};
+		const std::vector<std::uint32_t> first = values(0x5EED);
+		Expect("AsyncProducer sequence is fixed by the global seed", first.size() == 1000 && values(0x5EED) == first && values(0x5EEE) != first);
+
+		{
+			Random::AsyncProducer producer(true);
+			auto queue = producer.MakeQueue<Random::BasicStream<Random::Philox>>([](Random::BasicStream<Random::Philox>& s) { return s(); }, 128);
+			Expect("AsyncProducer queues take other stream types", Produced(*queue, 1000).size() == 1000);
+		}
+
+		std::shared_ptr<Random::AsyncProducer::Queue<Counter>> kept;
+		{
+			Random::AsyncProducer producer(true);
+			kept = producer.MakeQueue(Counter(), 64);
+			//the producer publishes a whole refill at once, so once 0 is out, 1 to 63 are ready too
+			Produced(*kept, 1);
+		}
+		std::vector<std::uint64_t> after(1000);
+		kept->Pop(after.data(), after.size());
+		Expect("queues outlive their producer", kept->Misses() > 0 && after[0] == 1 && after[62] == 63);
+
+		{
+			Random::AsyncProducer producer(false);
+			auto queue = producer.MakeQueue(Counter(), 64);
+			std::uint64_t last = 0;
+			for (int i = 0; i < 1000; i++) {
+				last = queue->Pop();
+			}
+			Expect("without a producer thread Pop generates inline", queue->Misses() == 1000 && last == 999);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	// recording
+
+	void Recording()
+	{
+		Random::Seed(0x5EED);
+		Random::Recorder recorder;
+		Random::GetIntVector(10, 0, 99);
+		recorder.AddMark(1);
+		const std::vector<int> recorded = Random::GetIntVector(50, 0, 99);
+		recorder.AddMark(2);
+		Random::GetIntVector(20, 0, 99);
+		recorder.AddMark(3);
+
+		recorder.SeekMark(0);
+		Expect("Recorder replays from a mark", Random::GetIntVector(50, 0, 99) == recorded);
+		Expect("Verify accepts a faithful replay", recorder.Verify(1));
+		recorder.Seek(recorder.Marks()[0].draws);
+		Expect("Seek matches SeekMark", Random::GetIntVector(50, 0, 99) == recorded);
+
+		recorder.Rewind();
+		Random::GetIntVector(10, 0, 99);
+		Expect("Verify accepts the first mark", recorder.Verify(0));
+		Random::GetIntVector(51, 0, 99);
+		Expect("Verify flags a diverging replay", !recorder.Verify(1));
+		Expect("Verify rejects a missing mark", !recorder.Verify(3));
+
+		std::vector<unsigned char> trace(recorder.TraceSize());
+		recorder.Save(trace.data(), trace.size());
+		Random::Seed(1);
+		Random::Recorder loaded;
+		loaded.Load(trace.data(), trace.size());
+		Random::GetIntVector(10, 0, 99);
+		Expect("loaded trace replays the recording", loaded.Verify(0) && Random::GetIntVector(50, 0, 99) == recorded && loaded.Verify(1));
+		Expect("Load rejects a truncated trace", Rejects([&] { loaded.Load(trace.data(), trace.size() - 1); }));
+		Expect("Save rejects a small buffer", Rejects([&] { recorder.Save(trace.data(), trace.size() - 1); }));
+
+		Random::Seed(2);
+		loaded.Restart();
+		Expect("Restart after Seed counts from the new state", loaded.Draws() == 0 && loaded.Marks().empty());
+
+		Random::Stream stream(0x5EED, 3);
+		Random::BasicRecorder<pcg32_oneseq> streamRecorder(stream.Engine());
+		Draw(stream, 100);
+		streamRecorder.AddMark(0);
+		const std::vector<std::uint32_t> fromStream = Draw(stream, 100);
+		streamRecorder.SeekMark(0);
+		Expect("Stream recorder replays from a mark", streamRecorder.Draws() == 100 && Draw(stream, 100) == fromStream);
+	}
+}
+
+int main()
+{
+	State();
+	Shuffling();
+	Weights();
+	Shapes<float>("float");
+	Shapes<double>("double");
+	Ranges();
+	LowDiscrepancy();
+#ifdef RANDOM_HAS_POSIX
+	Files();
+#endif
+	Recording();
+	Background();
+	std::printf("%d failure(s)\n", failures);
+	return failures ? 1 : 0;
+}